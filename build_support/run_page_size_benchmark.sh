@@ -0,0 +1,28 @@
+#!/bin/bash
+
+## =================================================================
+## PAGE SIZE BENCHMARK
+##
+## Builds BusTub once per page size and runs the page size
+## benchmark in each build.
+##
+## Usage: build_support/run_page_size_benchmark.sh [page sizes...]
+##   e.g. build_support/run_page_size_benchmark.sh 4096 16384
+## =================================================================
+
+set -o errexit
+
+SOURCE_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+PAGE_SIZES=("$@")
+if [ ${#PAGE_SIZES[@]} -eq 0 ]; then
+  PAGE_SIZES=(4096 8192 16384 32768)
+fi
+
+for page_size in "${PAGE_SIZES[@]}"; do
+  build_dir="${SOURCE_DIR}/build_page_size_${page_size}"
+  echo "==== BUSTUB_PAGE_SIZE=${page_size} (${build_dir}) ===="
+  cmake -S "${SOURCE_DIR}" -B "${build_dir}" -DCMAKE_BUILD_TYPE=Release -DBUSTUB_PAGE_SIZE="${page_size}" > /dev/null
+  cmake --build "${build_dir}" --target page_size_benchmark_test -- -j"$(nproc)" > /dev/null
+  (cd "${build_dir}" && ./test/page_size_benchmark_test --gtest_also_run_disabled_tests \
+    --gtest_filter='PageSizeBenchmarkTest.*')
+done
@@ -12,8 +12,10 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <future>  // NOLINT
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 namespace bustub {
 
@@ -22,6 +24,7 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   // We allocate a consecutive memory space for the buffer pool.
   pages_ = new Page[pool_size_];
   replacer_ = new ClockReplacer(pool_size);
+  disk_scheduler_ = new DiskScheduler(disk_manager);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -30,6 +33,8 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  // drain the writes of evicted pages first
+  delete disk_scheduler_;
   delete[] pages_;
   delete replacer_;
 }
@@ -49,9 +54,9 @@ bool BufferPoolManager::FindOneFreePage(frame_id_t *frame_id) {
     // delete it from the page table
     page_table_.erase(page_table_.find(page.page_id_));
 
-    // write it to the disk if dirty
+    // write it to the disk if dirty, the scheduler keeps a copy so we do not wait for the write
     if (page.IsDirty()) {
-      disk_manager_->WritePage(page.page_id_, page.GetData());
+      disk_scheduler_->ScheduleWrite(page.page_id_, page.GetData(), IOPriority::FOREGROUND_WRITE);
     }
   }
 
@@ -75,6 +80,8 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
     // the page already exists
     frame_id = page_table_[page_id];
     pages_[frame_id].pin_count_ += 1;
+    // an unpinned page sits in the replacer, it must not be evicted while pinned again
+    replacer_->Pin(frame_id);
   } else {
     // find one free page
     if (!FindOneFreePage(&frame_id)) {
@@ -86,7 +93,7 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
     page.page_id_ = page_id;
     page.pin_count_ = 1;
     page.is_dirty_ = false;
-    disk_manager_->ReadPage(page_id, page.GetData());
+    disk_scheduler_->ScheduleRead(page_id, page.GetData(), IOPriority::FOREGROUND_READ).get();
 
     // insert into the page table
     page_table_[page_id] = frame_id;
@@ -128,7 +135,7 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   }
 
   auto &page = pages_[page_table_[page_id]];
-  disk_manager_->WritePage(page.page_id_, page.GetData());
+  disk_scheduler_->ScheduleWrite(page.page_id_, page.GetData(), IOPriority::FOREGROUND_WRITE).get();
   page.is_dirty_ = false;
 
   return true;
@@ -175,7 +182,7 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
 
   if (page_table_.find(page_id) == page_table_.end()) {
     // page_id does not exist in the buffer pool
-    disk_manager_->DeallocatePage(page_id);
+    disk_scheduler_->DeallocatePage(page_id);
     return true;
   }
 
@@ -186,7 +193,7 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
     return false;
   }
 
-  disk_manager_->DeallocatePage(page_id);
+  disk_scheduler_->DeallocatePage(page_id);
 
   // now the page is still in the replacer, we should remove it
   // and add it into the freelist
@@ -203,11 +210,16 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
 void BufferPoolManager::FlushAllPagesImpl() {
   std::lock_guard<std::mutex> lock_guard(latch_);
 
+  // a checkpoint-style flush: queue everything in the background class so that adjacent pages are merged
+  std::vector<std::future<void>> writes;
   for (const auto &pair : page_table_) {
     auto &page = pages_[pair.second];
-    disk_manager_->WritePage(page.page_id_, page.GetData());
+    writes.push_back(disk_scheduler_->ScheduleWrite(page.page_id_, page.GetData(), IOPriority::BACKGROUND_FLUSH));
     page.is_dirty_ = false;
   }
+  for (auto &write : writes) {
+    write.wait();
+  }
 }
 
 }  // namespace bustub
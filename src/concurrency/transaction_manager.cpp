@@ -82,18 +82,26 @@ void TransactionManager::Abort(Transaction *txn) {
     // Metadata identifying the table that should be deleted from.
     TableMetadata *table_info = catalog->GetTable(item.table_oid_);
     IndexInfo *index_info = catalog->GetIndex(item.index_oid_);
-    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                            index_info->index_->GetKeyAttrs());
+    Index *index = index_info->index_.get();
+    // an index with included columns gets them back from the tuple along with the key
+    auto insert_entry = [&](const Tuple &tuple) {
+      auto key = tuple.KeyFromTuple(table_info->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
+      if (index->GetIncludeAttrs().empty()) {
+        index->InsertEntry(key, item.rid_, txn);
+      } else {
+        auto included = tuple.KeyFromTuple(table_info->schema_, *index->GetIncludeSchema(), index->GetIncludeAttrs());
+        index->InsertEntry(key, included, item.rid_, txn);
+      }
+    };
+    auto new_key = item.tuple_.KeyFromTuple(table_info->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
     if (item.wtype_ == WType::DELETE) {
-      index_info->index_->InsertEntry(new_key, item.rid_, txn);
+      insert_entry(item.tuple_);
     } else if (item.wtype_ == WType::INSERT) {
-      index_info->index_->DeleteEntry(new_key, item.rid_, txn);
+      index->DeleteEntry(new_key, item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
       // Delete the new key and insert the old key
-      index_info->index_->DeleteEntry(new_key, item.rid_, txn);
-      auto old_key = item.old_tuple_.KeyFromTuple(table_info->schema_, *(index_info->index_->GetKeySchema()),
-                                                  index_info->index_->GetKeyAttrs());
-      index_info->index_->InsertEntry(old_key, item.rid_, txn);
+      index->DeleteEntry(new_key, item.rid_, txn);
+      insert_entry(item.old_tuple_);
     }
     index_write_set->pop_back();
   }
@@ -0,0 +1,453 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *dir_page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (dir_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate directory page");
+  }
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id);
+  if (bucket_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate bucket page");
+  }
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData())->Init();
+  reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData())->Init(directory_page_id_, bucket_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::KeyToDirectoryIndex(const KeyType &key, HashTableDirectoryPage *dir_page) {
+  return Hash(key) & dir_page->GetGlobalDepthMask();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectoryPage() {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch directory page");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch bucket page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+bool EXTENDIBLE_HASH_TABLE_TYPE::VisitChain(page_id_t bucket_page_id, const Visit &visit) {
+  page_id_t page_id = bucket_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchBucketPage(page_id)->GetData());
+    bool dirty = false;
+    bool stop = visit(bucket, &dirty);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, dirty);
+    if (stop) {
+      return true;
+    }
+    page_id = next_page_id;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainContains(page_id_t bucket_page_id, const KeyType &key, const ValueType &value) {
+  return VisitChain(bucket_page_id, [&](HASH_TABLE_BUCKET_TYPE *bucket, bool * /* dirty */) {
+    return bucket->Contains(key, value, comparator_);
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::AppendToChain(page_id_t bucket_page_id, const KeyType &key, const ValueType &value,
+                                               bool grow) {
+  page_id_t page_id = bucket_page_id;
+  while (true) {
+    auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchBucketPage(page_id)->GetData());
+    if (bucket->Insert(key, value, comparator_)) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return true;
+    }
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (next_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+      continue;
+    }
+    if (!grow) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    page_id_t overflow_page_id;
+    Page *overflow_page = buffer_pool_manager_->NewPage(&overflow_page_id);
+    if (overflow_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate bucket page");
+    }
+    auto *overflow = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(overflow_page->GetData());
+    overflow->Init();
+    overflow->Insert(key, value, comparator_);
+    bucket->SetNextPageId(overflow_page_id);
+    buffer_pool_manager_->UnpinPage(overflow_page_id, true);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::CompactChain(HASH_TABLE_BUCKET_TYPE *bucket) {
+  // the first bucket stays in the chain even if empty, its page is the one in the directory
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  HASH_TABLE_BUCKET_TYPE *prev = bucket;
+  bool prev_dirty = false;
+  page_id_t page_id = bucket->GetNextPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto *overflow = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchBucketPage(page_id)->GetData());
+    page_id_t next_page_id = overflow->GetNextPageId();
+    if (overflow->IsEmpty()) {
+      prev->SetNextPageId(next_page_id);
+      prev_dirty = true;
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else {
+      if (prev_page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+      }
+      prev_page_id = page_id;
+      prev = overflow;
+      prev_dirty = false;
+    }
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::IsChainEmpty(page_id_t bucket_page_id) {
+  // a chain drops its overflow buckets as they empty
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchBucketPage(bucket_page_id)->GetData());
+  bool empty = bucket->IsEmpty() && bucket->GetNextPageId() == INVALID_PAGE_ID;
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  return empty;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->RLatch();
+  bool found = false;
+  VisitChain(bucket_page_id, [&](HASH_TABLE_BUCKET_TYPE *bucket, bool * /* dirty */) {
+    found = bucket->GetValue(key, comparator_, result) || found;
+    return false;
+  });
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  bool exists = ChainContains(bucket_page_id, key, value);
+  bool inserted = !exists && AppendToChain(bucket_page_id, key, value, false);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (!exists && !inserted) {
+    return SplitInsert(key, value);
+  }
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  // the bucket may have been split or emptied meanwhile, and all pairs may land on the same side of a split
+  bool inserted;
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    if (ChainContains(bucket_page_id, key, value)) {
+      inserted = false;
+      break;
+    }
+    if (AppendToChain(bucket_page_id, key, value, false)) {
+      inserted = true;
+      break;
+    }
+    if (!CanSplit(dir_page, bucket_idx, key)) {
+      inserted = AppendToChain(bucket_page_id, key, value, true);
+      break;
+    }
+    SplitBucket(dir_page, bucket_idx);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::CanSplit(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, const KeyType &key) {
+  // the bits of the hash a split of the bucket, or of its images, can still tell apart
+  uint32_t split_mask = (DIRECTORY_ARRAY_SIZE - 1) & ~dir_page->GetLocalDepthMask(bucket_idx);
+  uint32_t hash = Hash(key);
+  return VisitChain(dir_page->GetBucketPageId(bucket_idx), [&](HASH_TABLE_BUCKET_TYPE *bucket, bool * /* dirty */) {
+    for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && bucket->IsOccupied(i); i++) {
+      if (bucket->IsReadable(i) && ((Hash(bucket->KeyAt(i)) ^ hash) & split_mask) != 0) {
+        return true;
+      }
+    }
+    return false;
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx) {
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  BUSTUB_ASSERT(local_depth < DIRECTORY_MAX_DEPTH, "Bucket uses all the bits of the directory");
+  if (local_depth == dir_page->GetGlobalDepth()) {
+    dir_page->IncrGlobalDepth();
+  }
+  page_id_t image_page_id;
+  Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+  if (image_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate bucket page");
+  }
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(image_page->GetData())->Init();
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+
+  // the entries of the bucket whose next bit is set move to the image
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    if (dir_page->GetBucketPageId(i) == bucket_page_id) {
+      dir_page->SetLocalDepth(i, local_depth + 1);
+      if ((i & high_bit) != 0) {
+        dir_page->SetBucketPageId(i, image_page_id);
+      }
+    }
+  }
+  VisitChain(bucket_page_id, [&](HASH_TABLE_BUCKET_TYPE *bucket, bool *dirty) {
+    for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && bucket->IsOccupied(i); i++) {
+      if (bucket->IsReadable(i) && (Hash(bucket->KeyAt(i)) & high_bit) != 0) {
+        AppendToChain(image_page_id, bucket->KeyAt(i), bucket->ValueAt(i), true);
+        bucket->RemoveAt(i);
+        *dirty = true;
+      }
+    }
+    return false;
+  });
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchBucketPage(bucket_page_id)->GetData());
+  CompactChain(bucket);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = VisitChain(bucket_page_id, [&](HASH_TABLE_BUCKET_TYPE *chained, bool *dirty) {
+    return *dirty = chained->Remove(key, value, comparator_);
+  });
+  if (removed) {
+    CompactChain(bucket);
+  }
+  bool emptied = removed && bucket->IsEmpty() && bucket->GetNextPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (emptied) {
+    Merge(key);
+  }
+  return removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(const KeyType &key) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+  bool merged = false;
+  // a merged bucket may be merged again with the image one bit further up
+  while (dir_page->GetLocalDepth(bucket_idx) > 0) {
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    bool empty = IsChainEmpty(bucket_page_id);
+    bool image_empty = IsChainEmpty(image_page_id);
+    if (!empty && !image_empty) {
+      break;
+    }
+
+    page_id_t kept_page_id = empty ? image_page_id : bucket_page_id;
+    page_id_t freed_page_id = empty ? bucket_page_id : image_page_id;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, kept_page_id);
+        dir_page->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(freed_page_id);
+    merged = true;
+  }
+  while (dir_page->CanShrink()) {
+    dir_page->DecrGlobalDepth();
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, merged);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = FetchDirectoryPage()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  table_latch_.RLock();
+  FetchDirectoryPage()->VerifyIntegrity();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+}
+
+/*****************************************************************************
+ * STATISTICS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::CollectStatistics(IndexStatisticsCollector *collector,
+                                                   const std::function<Value(const KeyType &)> &first_column) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  collector->SetHeight(1);
+  // several entries share a bucket
+  std::unordered_set<page_id_t> seen;
+  for (uint32_t i = 0; i < dir_page->Size(); i++) {
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(i);
+    if (!seen.insert(bucket_page_id).second) {
+      continue;
+    }
+    Page *page = FetchBucketPage(bucket_page_id);
+    page->RLatch();
+    VisitChain(bucket_page_id, [&](HASH_TABLE_BUCKET_TYPE *bucket, bool * /* dirty */) {
+      for (slot_offset_t slot = 0; slot < BUCKET_ARRAY_SIZE && bucket->IsOccupied(slot); slot++) {
+        if (!bucket->IsReadable(slot)) {
+          continue;
+        }
+        KeyType key = bucket->KeyAt(slot);
+        if (first_column) {
+          Value value = first_column(key);
+          collector->AddKey(hash_fn_.GetHash(key), &value);
+        } else {
+          collector->AddKey(hash_fn_.GetHash(key), nullptr);
+        }
+      }
+      collector->AddPage(bucket->NumReadable(), BUCKET_ARRAY_SIZE);
+      return false;
+    });
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ExtendibleHashTable<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class ExtendibleHashTable<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExtendibleHashTable<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExtendibleHashTable<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExtendibleHashTable<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
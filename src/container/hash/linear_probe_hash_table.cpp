@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,25 +25,83 @@
 
 namespace bustub {
 
+namespace {
+
+// blocks of the old table each operation moves to the new one while a resize is in progress
+constexpr size_t RESIZE_MIGRATE_BLOCKS = 1;
+
+}  // namespace
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
-                                      HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+                                      HashFunction<KeyType> hash_fn, bool fingerprints)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      fingerprints_(fingerprints),
+      block_array_size_(fingerprints ? FINGERPRINT_BLOCK_ARRAY_SIZE : BLOCK_ARRAY_SIZE),
+      hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable((std::max<size_t>(num_buckets, 1) - 1) / block_array_size_ + 1);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  table_latch_.RLock();
+  bool found = false;
+  // a pair only moves from the old table to the new one, which is probed second
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    found = GetValueFrom(FetchHeaderPage(old_header_page_id_), key, result, false);
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  found = GetValueFrom(FetchHeaderPage(header_page_id_), key, result, found) || found;
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  bool migrated = MigrateBlocks(RESIZE_MIGRATE_BLOCKS, false);
+  table_latch_.RUnlock();
+  if (migrated) {
+    FinishResize();
+  }
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  while (true) {
+    table_latch_.RLock();
+    bool duplicate = false;
+    if (old_header_page_id_ != INVALID_PAGE_ID) {
+      duplicate = ContainsIn(FetchHeaderPage(old_header_page_id_), key, value);
+      buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    }
+    page_id_t header_page_id = header_page_id_;
+    HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+    InsertResult result = duplicate ? InsertResult::DUPLICATE : InsertInto(header, key, value);
+    size_t size = header->GetSize();
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+    if (result == InsertResult::INSERTED) {
+      num_pairs_++;
+    }
+    // rehash at three quarters of the slots occupied, unless the pairs of the last resize are still being moved;
+    // the table only doubles if the pairs take half of its slots, and otherwise just sheds its tombstones
+    bool rehash = result == InsertResult::FULL ||
+                  (old_header_page_id_ == INVALID_PAGE_ID && num_occupied_ * 4 >= size * 3);
+    bool migrated = MigrateBlocks(RESIZE_MIGRATE_BLOCKS, false);
+    table_latch_.RUnlock();
+    if (migrated) {
+      FinishResize();
+    }
+    if (rehash) {
+      ResizeTo(header_page_id, num_pairs_ * 2 >= size ? 2 * size : size);
+    }
+    if (result != InsertResult::FULL) {
+      return result == InsertResult::INSERTED;
+    }
+  }
 }
 
 /*****************************************************************************
@@ -48,21 +109,429 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  bool removed = false;
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    removed = RemoveFrom(FetchHeaderPage(old_header_page_id_), key, value);
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  }
+  if (!removed) {
+    removed = RemoveFrom(FetchHeaderPage(header_page_id_), key, value);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  }
+  if (removed) {
+    num_pairs_--;
+  }
+  bool migrated = MigrateBlocks(RESIZE_MIGRATE_BLOCKS, false);
+  table_latch_.RUnlock();
+  if (migrated) {
+    FinishResize();
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.RLock();
+  page_id_t header_page_id = header_page_id_;
+  table_latch_.RUnlock();
+  ResizeTo(header_page_id, 2 * initial_size);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ResizeTo(page_id_t header_page_id, size_t num_slots) {
+  std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  // a resize in progress is completed first, there is room for one old table
+  table_latch_.RLock();
+  bool migrated = MigrateBlocks(std::numeric_limits<size_t>::max(), true);
+  bool resized = header_page_id_ != header_page_id;
+  table_latch_.RUnlock();
+  if (migrated) {
+    FinishResize();
+  }
+  if (migrate_full_) {
+    MergeTables();
+    return;
+  }
+  if (resized) {
+    // another insert that found the table full resized it already
+    return;
+  }
+
+  page_id_t new_header_page_id = CreateTable((std::max<size_t>(num_slots, 1) - 1) / block_array_size_ + 1);
+  table_latch_.WLock();
+  BUSTUB_ASSERT(old_header_page_id_ == INVALID_PAGE_ID, "Resize in progress");
+  old_header_page_id_ = header_page_id_;
+  header_page_id_ = new_header_page_id;
+  migrate_next_ = 0;
+  num_occupied_ = 0;
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::MigrateBlocks(size_t num_blocks, bool wait) {
+  if (old_header_page_id_ == INVALID_PAGE_ID || migrate_full_) {
+    return false;
+  }
+  std::unique_lock<std::mutex> migrate_guard(migrate_latch_, std::defer_lock);
+  if (wait) {
+    migrate_guard.lock();
+  } else if (!migrate_guard.try_lock()) {
+    return false;
+  }
+  HashTableHeaderPage *old_header = FetchHeaderPage(old_header_page_id_);
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id_);
+  for (size_t i = 0; i < num_blocks && !migrate_full_ && migrate_next_ < old_header->NumBlocks(); i++) {
+    page_id_t block_page_id = old_header->GetBlockPageId(migrate_next_);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch block page");
+    }
+    // probes of the old table wait for the whole block to move
+    page->WLatch();
+    VisitBlock(page, [&](auto *block) {
+      for (slot_offset_t slot = 0; slot < block_array_size_ && !migrate_full_; slot++) {
+        if (!block->IsReadable(slot)) {
+          continue;
+        }
+        // concurrent inserts filled the new table first: the pair stays, and the next resize merges both tables
+        if (InsertInto(header, block->KeyAt(slot), block->ValueAt(slot)) == InsertResult::FULL) {
+          migrate_full_ = true;
+        } else {
+          block->Remove(slot);
+        }
+      }
+    });
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    if (!migrate_full_) {
+      migrate_next_++;
+    }
+  }
+  bool migrated = migrate_next_ == old_header->NumBlocks();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  return migrated;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishResize() {
+  table_latch_.WLock();
+  // another operation may have finished it first
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    size_t num_blocks = FetchHeaderPage(old_header_page_id_)->NumBlocks();
+    buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+    if (migrate_next_ == num_blocks) {
+      DeleteTable(old_header_page_id_);
+      old_header_page_id_ = INVALID_PAGE_ID;
+    }
+  }
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MergeTables() {
+  table_latch_.WLock();
+  if (!migrate_full_) {
+    table_latch_.WUnlock();
+    return;
+  }
+  // twice the size of the current table, and at least twice the slots the pairs of both take
+  size_t num_blocks = FetchHeaderPage(header_page_id_)->NumBlocks();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  page_id_t merged_header_page_id =
+      CreateTable(std::max(2 * num_blocks, 2 * num_pairs_ / block_array_size_ + 1));
+  HashTableHeaderPage *merged_header = FetchHeaderPage(merged_header_page_id);
+  size_t num_occupied = num_occupied_.exchange(0);
+  bool full = false;
+  for (page_id_t header_page_id : {old_header_page_id_, header_page_id_}) {
+    HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+    for (size_t i = 0; i < header->NumBlocks() && !full; i++) {
+      page_id_t block_page_id = header->GetBlockPageId(i);
+      Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+      if (page == nullptr) {
+        full = true;
+        break;
+      }
+      VisitBlock(page, [&](auto *block) {
+        for (slot_offset_t slot = 0; slot < block_array_size_ && !full; slot++) {
+          if (block->IsReadable(slot)) {
+            full = InsertInto(merged_header, block->KeyAt(slot), block->ValueAt(slot)) == InsertResult::FULL;
+          }
+        }
+      });
+      buffer_pool_manager_->UnpinPage(block_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+  }
+  buffer_pool_manager_->UnpinPage(merged_header_page_id, true);
+  if (full) {
+    // both tables are left as they were
+    DeleteTable(merged_header_page_id);
+    num_occupied_ = num_occupied;
+    table_latch_.WUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot merge hash tables");
+  }
+  DeleteTable(old_header_page_id_);
+  DeleteTable(header_page_id_);
+  header_page_id_ = merged_header_page_id;
+  old_header_page_id_ = INVALID_PAGE_ID;
+  migrate_next_ = 0;
+  migrate_full_ = false;
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = FetchHeaderPage(header_page_id_)->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch header page");
+  }
+  return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::CreateTable(size_t num_blocks) {
+  if (num_blocks > HashTableHeaderPage::MaxNumBlocks()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Hash table has more blocks than its header page holds");
+  }
+  page_id_t header_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate header page");
+  }
+  // new pages are zeroed, which leaves every slot of a block free
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header->SetPageId(header_page_id);
+  header->SetLSN(INVALID_LSN);
+  header->SetSize(num_blocks * block_array_size_);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      buffer_pool_manager_->UnpinPage(header_page_id, true);
+      DeleteTable(header_page_id);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate block page");
+    }
+    header->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteTable(page_id_t header_page_id) {
+  HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+  for (size_t i = 0; i < header->NumBlocks(); i++) {
+    buffer_pool_manager_->DeletePage(header->GetBlockPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+void HASH_TABLE_TYPE::VisitBlock(Page *page, const Visit &visit) {
+  if (fingerprints_) {
+    visit(reinterpret_cast<HASH_TABLE_FINGERPRINT_BLOCK_TYPE *>(page->GetData()));
+  } else {
+    visit(reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData()));
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visit>
+bool HASH_TABLE_TYPE::Probe(HashTableHeaderPage *header, const KeyType &key, bool dirty, const Visit &visit) {
+  using FingerprintBlock = HASH_TABLE_FINGERPRINT_BLOCK_TYPE;
+  size_t size = header->GetSize();
+  uint64_t hash = hash_fn_.GetHash(key);
+  uint8_t fingerprint = FingerprintBlock::Fingerprint(hash);
+  size_t slot = hash % size;
+  for (size_t probed = 0; probed < size;) {
+    page_id_t block_page_id = header->GetBlockPageId(slot / block_array_size_);
+    Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch block page");
+    }
+    // writers latch a block exclusively, so that checking it for the pair and claiming a slot are one step to other
+    // inserts of the same pair
+    if (dirty) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    bool stop = false;
+    slot_offset_t offset = slot % block_array_size_;
+    if (fingerprints_) {
+      auto *block = reinterpret_cast<FingerprintBlock *>(page->GetData());
+      while (!stop && offset < block_array_size_ && probed < size) {
+        // a slot whose fingerprint does not match holds another key; the first free slot ends the probe, or is
+        // taken by an insert
+        size_t width = std::min({FingerprintBlock::GROUP_SIZE, block_array_size_ - offset, size - probed});
+        uint32_t empty;
+        uint32_t candidates = block->MatchGroup(offset, fingerprint, &empty) | empty;
+        candidates &= width < 32 ? (1U << width) - 1 : ~0U;
+        for (; !stop && candidates != 0; candidates &= candidates - 1) {
+          stop = visit(block, offset + __builtin_ctz(candidates));
+        }
+        offset += width;
+        probed += width;
+      }
+    } else {
+      auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+      for (; !stop && offset < block_array_size_ && probed < size; offset++, probed++) {
+        stop = visit(block, offset);
+      }
+    }
+    if (dirty) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, dirty);
+    if (stop) {
+      return true;
+    }
+    // the table is a whole number of blocks
+    slot = (slot / block_array_size_ + 1) * block_array_size_ % size;
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::GetValueFrom(HashTableHeaderPage *header, const KeyType &key, std::vector<ValueType> *result,
+                                   bool dedup) {
+  size_t num_found = result->size();
+  size_t num_before = num_found;
+  Probe(header, key, false, [&](auto *block, slot_offset_t slot) {
+    if (!block->IsOccupied(slot)) {
+      return true;
+    }
+    if (block->IsReadable(slot) && comparator_(block->KeyAt(slot), key) == 0) {
+      ValueType value = block->ValueAt(slot);
+      // a pair that moved between the probes of the old and the new table is found in both
+      if (!dedup || std::find(result->begin(), result->begin() + num_before, value) == result->begin() + num_before) {
+        result->push_back(value);
+      }
+      num_found++;
+    }
+    return false;
+  });
+  return num_found > num_before;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::ContainsIn(HashTableHeaderPage *header, const KeyType &key, const ValueType &value) {
+  bool found = false;
+  Probe(header, key, false, [&](auto *block, slot_offset_t slot) {
+    found = block->IsReadable(slot) && comparator_(block->KeyAt(slot), key) == 0 && block->ValueAt(slot) == value;
+    return found || !block->IsOccupied(slot);
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertInto(HashTableHeaderPage *header, const KeyType &key, const ValueType &value)
+    -> InsertResult {
+  InsertResult result = InsertResult::FULL;
+  uint8_t fingerprint = fingerprints_ ? HASH_TABLE_FINGERPRINT_BLOCK_TYPE::Fingerprint(hash_fn_.GetHash(key)) : 0;
+  Probe(header, key, true, [&](auto *block, slot_offset_t slot) {
+    if (block->IsReadable(slot) && comparator_(block->KeyAt(slot), key) == 0 && block->ValueAt(slot) == value) {
+      result = InsertResult::DUPLICATE;
+      return true;
+    }
+    // the slot may be claimed by a concurrent insert first, the probe goes on then
+    if (!block->IsOccupied(slot) && InsertAt(block, slot, key, value, fingerprint)) {
+      num_occupied_++;
+      result = InsertResult::INSERTED;
+      return true;
+    }
+    return false;
+  });
+  return result;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::RemoveFrom(HashTableHeaderPage *header, const KeyType &key, const ValueType &value) {
+  bool removed = false;
+  Probe(header, key, true, [&](auto *block, slot_offset_t slot) {
+    if (!block->IsOccupied(slot)) {
+      return true;
+    }
+    if (block->IsReadable(slot) && comparator_(block->KeyAt(slot), key) == 0 && block->ValueAt(slot) == value) {
+      block->Remove(slot);
+      removed = true;
+      return true;
+    }
+    return false;
+  });
+  return removed;
+}
+
+/*****************************************************************************
+ * STATISTICS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CollectStatistics(IndexStatisticsCollector *collector,
+                                        const std::function<Value(const KeyType &)> &first_column) {
+  table_latch_.RLock();
+  collector->SetHeight(1);
+  // while a resize is in progress, a pair that moves during the walk may be counted twice
+  for (page_id_t header_page_id : {old_header_page_id_, header_page_id_}) {
+    if (header_page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    HashTableHeaderPage *header = FetchHeaderPage(header_page_id);
+    for (size_t i = 0; i < header->NumBlocks(); i++) {
+      page_id_t block_page_id = header->GetBlockPageId(i);
+      Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+      if (page == nullptr) {
+        buffer_pool_manager_->UnpinPage(header_page_id, false);
+        table_latch_.RUnlock();
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch block page");
+      }
+      page->RLatch();
+      size_t used = 0;
+      VisitBlock(page, [&](auto *block) {
+        for (slot_offset_t slot = 0; slot < block_array_size_; slot++) {
+          if (!block->IsReadable(slot)) {
+            continue;
+          }
+          used++;
+          KeyType key = block->KeyAt(slot);
+          if (first_column) {
+            Value value = first_column(key);
+            collector->AddKey(hash_fn_.GetHash(key), &value);
+          } else {
+            collector->AddKey(hash_fn_.GetHash(key), nullptr);
+          }
+        }
+      });
+      collector->AddPage(used, block_array_size_);
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(block_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+  }
+  table_latch_.RUnlock();
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -73,4 +542,10 @@ template class LinearProbeHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class LinearProbeHashTable<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class LinearProbeHashTable<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class LinearProbeHashTable<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class LinearProbeHashTable<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class LinearProbeHashTable<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.cpp
+//
+// Identification: src/execution/index_only_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/executors/index_only_scan_executor.h"
+
+namespace bustub {
+IndexOnlyScanExecutor::IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexOnlyScanExecutor::Init() {
+  results_.clear();
+  next_ = 0;
+  Index *index = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->index_.get();
+  const Schema *covered_schema = index->GetMetadata()->GetCoveredSchema();
+  const Schema *output_schema = plan_->OutputSchema();
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  index->ScanRange(
+      plan_->GetLowKey(), plan_->GetHighKey(),
+      [&](const Tuple &entry, RID rid) {
+        if (predicate == nullptr || predicate->Evaluate(&entry, covered_schema).GetAs<bool>()) {
+          std::vector<Value> values;
+          values.reserve(output_schema->GetColumnCount());
+          for (const auto &column : output_schema->GetColumns()) {
+            values.push_back(column.GetExpr()->Evaluate(&entry, covered_schema));
+          }
+          results_.emplace_back(Tuple(values, output_schema), rid);
+        }
+        return true;
+      },
+      exec_ctx_->GetTransaction());
+}
+
+bool IndexOnlyScanExecutor::Next(Tuple *tuple, RID *rid) {
+  if (next_ == results_.size()) {
+    return false;
+  }
+  *tuple = results_[next_].first;
+  *rid = results_[next_].second;
+  next_++;
+  return true;
+}
+
+}  // namespace bustub
@@ -20,6 +20,7 @@
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -98,6 +99,9 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return the scheduler that all page I/O of this buffer pool goes through */
+  DiskScheduler *GetDiskScheduler() { return disk_scheduler_; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -169,6 +173,8 @@ class BufferPoolManager {
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
+  /** Scheduler in front of the disk manager, every page read and write goes through it. */
+  DiskScheduler *disk_scheduler_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
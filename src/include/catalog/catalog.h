@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -10,6 +14,7 @@
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/index/var_length_b_plus_tree_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -51,6 +56,12 @@ struct IndexInfo {
   index_oid_t index_oid_;
   std::string table_name_;
   const size_t key_size_;
+  // gathered by Catalog::AnalyzeIndex, nullptr until then; replaced as a whole under statistics_latch_, so those
+  // handed out earlier stay valid
+  std::shared_ptr<const IndexStatistics> statistics_;
+  // the modification count of the index when statistics_ were gathered
+  uint64_t analyzed_modifications_{0};
+  std::mutex statistics_latch_;
 };
 
 /**
@@ -59,6 +70,9 @@ struct IndexInfo {
  */
 class Catalog {
  public:
+  // share of its entries an index sees inserted or deleted before GetIndexStatistics analyzes it again
+  static constexpr double REANALYZE_FRACTION = 0.1;
+
   /**
    * Creates a new catalog object.
    * @param bpm the buffer pool manager backing tables created by this catalog
@@ -77,17 +91,25 @@ class Catalog {
    */
   TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    return nullptr;
+    table_oid_t table_oid = next_table_oid_++;
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    auto metadata = std::make_unique<TableMetadata>(schema, table_name, std::move(table), table_oid);
+    auto *result = metadata.get();
+    tables_.emplace(table_oid, std::move(metadata));
+    names_.emplace(table_name, table_oid);
+    return result;
   }
 
-  /** @return table metadata by name */
-  TableMetadata *GetTable(const std::string &table_name) { return nullptr; }
+  /** @return table metadata by name, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(const std::string &table_name) { return GetTable(names_.at(table_name)); }
 
-  /** @return table metadata by oid */
-  TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
+  /** @return table metadata by oid, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(table_oid_t table_oid) { return tables_.at(table_oid).get(); }
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
+   * The existing rows are sorted by key and bulk loaded into the index instead of being inserted one by one; worker
+   * threads read and sort a range of the table pages each, and their sorted runs are merged into the bulk load.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -95,25 +117,166 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param unique false if several rows may have the same key, each row is indexed then
+   * @param include_attrs columns to store along with the keys, for index-only scans; they need a CoveringValue as
+   * ValueType, whose payload they fit into, and unique keys
+   * @param num_workers threads that read and sort the existing rows, one per hardware thread by default; a single one
+   * is used while logging is enabled
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    return nullptr;
+                         size_t keysize, bool unique = true, const std::vector<uint32_t> &include_attrs = {},
+                         size_t num_workers = std::thread::hardware_concurrency()) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique!");
+    BUSTUB_ASSERT(include_attrs.empty() == (std::is_same_v<ValueType, RID>), "Included columns need a payload");
+    BUSTUB_ASSERT(include_attrs.empty() || unique, "Included columns need unique keys");
+    TableHeap *table = GetTable(table_name)->table_.get();
+    auto *metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs, unique, include_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(metadata, bpm_);
+
+    // each worker extracts the pairs of a contiguous range of table pages and sorts them into a run; the runs are
+    // merged as they are loaded. Locking the rows goes through the transaction, which is not shared between threads
+    std::vector<page_id_t> page_ids = table->GetPageIds();
+    num_workers = enable_logging ? 1 : std::clamp<size_t>(num_workers, 1, std::max<size_t>(page_ids.size(), 1));
+    std::vector<std::vector<std::pair<KeyType, ValueType>>> runs(num_workers);
+    KeyComparator comparator(metadata->GetKeySchema());
+    auto build_run = [&](size_t worker) {
+      auto &run = runs[worker];
+      auto add_pair = [&](const Tuple &tuple) {
+        KeyType key;
+        key.SetFromKey(tuple.KeyFromTuple(schema, key_schema, key_attrs), key_schema);
+        ValueType value(tuple.GetRid());
+        if constexpr (!std::is_same_v<ValueType, RID>) {
+          value.SetFromTuple(tuple.KeyFromTuple(schema, *metadata->GetIncludeSchema(), include_attrs));
+        }
+        run.emplace_back(key, value);
+      };
+      for (size_t i = worker * page_ids.size() / num_workers; i < (worker + 1) * page_ids.size() / num_workers; i++) {
+        table->ScanPage(page_ids[i], add_pair, txn);
+      }
+      // the rows of a key are loaded in record id order, or only the first of them into a unique index
+      std::stable_sort(run.begin(), run.end(), [&comparator, unique](const auto &a, const auto &b) {
+        int order = comparator(a.first, b.first);
+        return order < 0 || (order == 0 && !unique && RID(a.second).Get() < RID(b.second).Get());
+      });
+    };
+    std::vector<std::thread> workers;
+    for (size_t worker = 1; worker < num_workers; worker++) {
+      workers.emplace_back(build_run, worker);
+    }
+    build_run(0);
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    index->BulkLoad(runs);
+
+    index_oid_t index_oid = next_index_oid_++;
+    auto info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto *result = info.get();
+    indexes_.emplace(index_oid, std::move(info));
+    index_names_[table_name].emplace(index_name, index_oid);
+    return result;
+  }
+
+  /**
+   * Create a new index on keys of any length, populate existing data of the table and return its metadata.
+   * Each key only takes as many bytes as it needs, see VarLengthBPlusTreeIndex; the key size is recorded as zero.
+   * @param txn the transaction in which the table is being created
+   * @param index_name the name of the new index
+   * @param table_name the name of the table
+   * @param schema the schema of the table
+   * @param key_schema the schema of the key
+   * @param key_attrs key attributes
+   * @param unique false if several rows may have the same key, each row is indexed then
+   * @return a pointer to the metadata of the new table
+   */
+  IndexInfo *CreateVarLengthIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                                  const Schema &schema, const Schema &key_schema,
+                                  const std::vector<uint32_t> &key_attrs, bool unique = true) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique!");
+    TableHeap *table = GetTable(table_name)->table_.get();
+    auto *metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs, unique);
+    auto index = std::make_unique<VarLengthBPlusTreeIndex>(metadata, bpm_);
+    for (auto it = table->Begin(txn); it != table->End(); ++it) {
+      index->InsertEntry(it->KeyFromTuple(schema, key_schema, key_attrs), it->GetRid(), txn);
+    }
+
+    index_oid_t index_oid = next_index_oid_++;
+    auto info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, 0);
+    auto *result = info.get();
+    indexes_.emplace(index_oid, std::move(info));
+    index_names_[table_name].emplace(index_name, index_oid);
+    return result;
   }
 
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  /** @return index metadata by name, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    return GetIndex(index_names_.at(table_name).at(index_name));
+  }
 
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  /** @return index metadata by oid, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(index_oid_t index_oid) { return indexes_.at(index_oid).get(); }
 
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  /**
+   * Gather the statistics of an index and keep them in its metadata, replacing those of an earlier analysis. They are
+   * not maintained entry by entry, which would put a sketch update on every write; instead each index counts its
+   * inserts and deletes, and GetIndexStatistics analyzes it again once they reach REANALYZE_FRACTION of its entries.
+   * @param txn the transaction in which the index is analyzed
+   * @param index_name the name of the index
+   * @param table_name the name of the table
+   * @return the new statistics, throws NotImplementedException if the index cannot collect them
+   */
+  std::shared_ptr<const IndexStatistics> AnalyzeIndex(Transaction *txn, const std::string &index_name,
+                                                      const std::string &table_name) {
+    IndexInfo *info = GetIndex(index_name, table_name);
+    // changes made during the pass count towards the next analysis
+    uint64_t modifications = info->index_->GetModificationCount();
+    auto statistics = std::make_shared<const IndexStatistics>(info->index_->CollectStatistics(txn));
+    std::lock_guard<std::mutex> guard(info->statistics_latch_);
+    info->statistics_ = statistics;
+    info->analyzed_modifications_ = modifications;
+    return statistics;
+  }
+
+  /**
+   * @return the statistics of an index, analyzed first if it never was or if the entries inserted and deleted since
+   * reach REANALYZE_FRACTION of those it had then
+   */
+  std::shared_ptr<const IndexStatistics> GetIndexStatistics(Transaction *txn, const std::string &index_name,
+                                                            const std::string &table_name) {
+    IndexInfo *info = GetIndex(index_name, table_name);
+    {
+      std::lock_guard<std::mutex> guard(info->statistics_latch_);
+      if (info->statistics_ != nullptr) {
+        uint64_t changed = info->index_->GetModificationCount() - info->analyzed_modifications_;
+        auto threshold =
+            std::max<uint64_t>(1, static_cast<uint64_t>(info->statistics_->num_entries_ * REANALYZE_FRACTION));
+        if (changed < threshold) {
+          return info->statistics_;
+        }
+      }
+    }
+    return AnalyzeIndex(txn, index_name, table_name);
+  }
+
+  /** @return all indexes of the table */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> result;
+    auto it = index_names_.find(table_name);
+    if (it != index_names_.end()) {
+      for (const auto &[name, index_oid] : it->second) {
+        result.push_back(indexes_.at(index_oid).get());
+      }
+    }
+    return result;
+  }
 
  private:
-  [[maybe_unused]] BufferPoolManager *bpm_;
-  [[maybe_unused]] LockManager *lock_manager_;
-  [[maybe_unused]] LogManager *log_manager_;
+  BufferPoolManager *bpm_;
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
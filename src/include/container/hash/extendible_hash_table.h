@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/index/index_statistics.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool manager. Non-unique keys are supported.
+ * Supports insert and delete. The low bits of the hash of a key pick an entry of the directory page, which holds the
+ * page id of its bucket page.
+ *
+ * Unlike LinearProbeHashTable, which rehashes all of its blocks once full, the table grows one bucket at a time: a
+ * full bucket is split in two by one more bit of the hash, and the directory only doubles, by copying its entries,
+ * when the bucket already used all of its bits. An empty bucket is merged back into its split image, and the
+ * directory halves once no bucket needs all of its bits any more.
+ *
+ * A split only helps if the pairs of the bucket differ in the bits of the hash the directory has left. A bucket whose
+ * pairs all share those bits, as the duplicates of a single key do, grows a chain of overflow buckets instead, see
+ * HashTableBucketPage. Overflow buckets are dropped from the chain as they empty.
+ *
+ * Lookups, inserts and removes share table_latch_ and latch the first bucket page of their chain. Splits and merges,
+ * which change the directory, hold table_latch_ exclusively, for the time it takes to move the pairs of a single
+ * bucket.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable, with a directory of a single bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair exists
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /** @return the global depth of the directory */
+  uint32_t GetGlobalDepth();
+
+  /** Assert the invariants of the directory, see HashTableDirectoryPage::VerifyIntegrity. */
+  void VerifyIntegrity();
+
+  /**
+   * Feeds the collector the buckets of the table and their keys, one bucket read latched at a time.
+   * @param collector the statistics collector
+   * @param first_column decodes the first column of a key for the histogram, empty if keys cannot be decoded
+   */
+  void CollectStatistics(IndexStatisticsCollector *collector,
+                         const std::function<Value(const KeyType &)> &first_column);
+
+ private:
+  uint32_t Hash(const KeyType &key);
+
+  uint32_t KeyToDirectoryIndex(const KeyType &key, HashTableDirectoryPage *dir_page);
+
+  HashTableDirectoryPage *FetchDirectoryPage();
+
+  /** @return the pinned page of a bucket, whose data is a HASH_TABLE_BUCKET_TYPE */
+  Page *FetchBucketPage(page_id_t bucket_page_id);
+
+  /**
+   * Call visit on the buckets of a chain in turn, until it returns true. visit sets its second argument if it
+   * changed the bucket.
+   * @return whether visit returned true
+   */
+  template <typename Visit>
+  bool VisitChain(page_id_t bucket_page_id, const Visit &visit);
+
+  /** @return whether a bucket of a chain holds the pair */
+  bool ChainContains(page_id_t bucket_page_id, const KeyType &key, const ValueType &value);
+
+  /**
+   * Insert a pair, which the chain does not hold, into its first bucket with a free slot.
+   * @param grow whether to append an overflow bucket to a full chain
+   * @return false if the chain is full and grow is false
+   */
+  bool AppendToChain(page_id_t bucket_page_id, const KeyType &key, const ValueType &value, bool grow);
+
+  /** Drop the empty overflow buckets of the chain that starts with a pinned bucket. */
+  void CompactChain(HASH_TABLE_BUCKET_TYPE *bucket);
+
+  /** @return whether a chain holds no pair */
+  bool IsChainEmpty(page_id_t bucket_page_id);
+
+  /** Split the bucket of the key until the pair fits, or chain an overflow bucket, holding table_latch_ exclusively. */
+  bool SplitInsert(const KeyType &key, const ValueType &value);
+
+  /**
+   * @return whether the pairs of the bucket of a directory entry and the key differ in a bit of the hash that the
+   * bucket, or its split images, could still be split by
+   */
+  bool CanSplit(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, const KeyType &key);
+
+  /** Split the bucket of a directory entry by the next bit of the hash, doubling the directory if needed. */
+  void SplitBucket(HashTableDirectoryPage *dir_page, uint32_t bucket_idx);
+
+  /** Merge the emptied bucket of the key into its split image as long as either is empty, then shrink the directory. */
+  void Merge(const KeyType &key);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers includes inserts and removes, writers are splits and merges
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
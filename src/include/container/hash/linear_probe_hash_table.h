@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -20,7 +23,9 @@
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
 #include "container/hash/hash_table.h"
+#include "storage/index/index_statistics.h"
 #include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_fingerprint_block_page.h"
 #include "storage/page/hash_table_header_page.h"
 #include "storage/page/hash_table_page_defs.h"
 
@@ -32,6 +37,24 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * A table is a header page, which holds the page ids of its blocks, and the
+ * blocks, whose slots are probed in order from the hash of a key. Removed pairs
+ * leave tombstones, which keep probes going until the table is resized.
+ *
+ * The table doubles once three quarters of its slots are occupied, without
+ * stopping lookups and writers for more than a swap of header pages: the new
+ * blocks are allocated aside, and the pairs of the old ones are moved over a
+ * block at a time, by every operation that comes along. Until the last block
+ * is moved, inserts go to the new table, and lookups and removes probe the old
+ * one before the new one. A pair is copied to the new table before it is
+ * removed from the old one, under the write latch of its old block, so that a
+ * probe in that order never misses it.
+ *
+ * Blocks are HashTableFingerprintBlockPage by default, whose probes skip the
+ * slots of other keys a group at a time by their fingerprints, or
+ * HashTableBlockPage, which fits a few more pairs but compares the key of every
+ * slot it probes.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -43,9 +66,11 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    * @param comparator comparator for keys
    * @param num_buckets initial number of buckets contained by this hash table
    * @param hash_fn the hash function
+   * @param fingerprints whether blocks keep a fingerprint per slot, see HashTableFingerprintBlockPage
    */
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
+                                const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn,
+                                bool fingerprints = true);
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -75,7 +100,9 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. Only
+   * allocates the new table, whose pairs are moved over by later operations;
+   * a resize that is still moving pairs is completed first.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -86,15 +113,106 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    */
   size_t GetSize();
 
+  /**
+   * Feeds the collector the blocks of the table and their keys, one block read latched at a time.
+   * @param collector the statistics collector
+   * @param first_column decodes the first column of a key for the histogram, empty if keys cannot be decoded
+   */
+  void CollectStatistics(IndexStatisticsCollector *collector,
+                         const std::function<Value(const KeyType &)> &first_column);
+
  private:
+  enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+  HashTableHeaderPage *FetchHeaderPage(page_id_t header_page_id);
+
+  /** Allocate a table of num_blocks empty blocks, @return the page id of its header page */
+  page_id_t CreateTable(size_t num_blocks);
+
+  /** Delete the header page and the blocks of a table. */
+  void DeleteTable(page_id_t header_page_id);
+
+  /**
+   * Visit the slots of a table in probe order from the slot of key, each block read latched in turn, or write latched
+   * if the probe may change it, until visit returns true or every slot was visited. Blocks with fingerprints only have
+   * the slots that may hold key and the free ones visited.
+   * @param visit called with the block, as either block page type, and the slot
+   * @return whether visit stopped the probe
+   */
+  template <typename Visit>
+  bool Probe(HashTableHeaderPage *header, const KeyType &key, bool dirty, const Visit &visit);
+
+  /** Call visit with the block page of a page, as laid out in this table. */
+  template <typename Visit>
+  void VisitBlock(Page *page, const Visit &visit);
+
+  static bool InsertAt(HASH_TABLE_BLOCK_TYPE *block, slot_offset_t slot, const KeyType &key, const ValueType &value,
+                       uint8_t fingerprint) {
+    return block->Insert(slot, key, value);
+  }
+
+  static bool InsertAt(HASH_TABLE_FINGERPRINT_BLOCK_TYPE *block, slot_offset_t slot, const KeyType &key,
+                       const ValueType &value, uint8_t fingerprint) {
+    return block->Insert(slot, key, value, fingerprint);
+  }
+
+  /** Append the values of key in a table to result, skipping those it holds already if dedup is set. */
+  bool GetValueFrom(HashTableHeaderPage *header, const KeyType &key, std::vector<ValueType> *result, bool dedup);
+
+  bool ContainsIn(HashTableHeaderPage *header, const KeyType &key, const ValueType &value);
+
+  InsertResult InsertInto(HashTableHeaderPage *header, const KeyType &key, const ValueType &value);
+
+  bool RemoveFrom(HashTableHeaderPage *header, const KeyType &key, const ValueType &value);
+
+  /**
+   * Move up to num_blocks blocks of the old table to the new one, with table_latch_ shared. Unless wait is set, leave
+   * them to the thread that is moving blocks already.
+   * @return whether a resize is in progress and all of its blocks are moved, see FinishResize
+   */
+  bool MigrateBlocks(size_t num_blocks, bool wait);
+
+  /** Delete the old table once all of its blocks are moved, with table_latch_ held exclusively. */
+  void FinishResize();
+
+  /**
+   * Move the pairs of both tables into a new one at least twice the size of the current table, with table_latch_ held
+   * exclusively, once the current table filled up before all the blocks of the old one were moved to it.
+   */
+  void MergeTables();
+
+  /**
+   * Start moving the pairs to a new table of at least num_slots slots, unless the table at header_page_id was
+   * resized already, by a concurrent insert that found it full as well.
+   */
+  void ResizeTo(page_id_t header_page_id, size_t num_slots);
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  // layout of the blocks, and the pairs one holds
+  bool fingerprints_;
+  size_t block_array_size_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts, removes and moving blocks, writer is only the swap of the tables and the deletion of
+  // the old one
   ReaderWriterLatch table_latch_;
 
+  // the table being moved to header_page_id_ while a resize is in progress
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // next block of the old table to move, guarded by migrate_latch_
+  size_t migrate_next_{0};
+  std::mutex migrate_latch_;
+  // set once the new table has no room for the next pair of the old one, which stops moving blocks until MergeTables
+  std::atomic<bool> migrate_full_{false};
+  // held by a resize throughout, so that concurrent inserts that find the table full grow it once
+  std::mutex resize_latch_;
+  // occupied slots of the table at header_page_id_, tombstones included
+  std::atomic<size_t> num_occupied_{0};
+  // pairs in either table
+  std::atomic<size_t> num_pairs_{0};
+
   // Hash function
   HashFunction<KeyType> hash_fn_;
 };
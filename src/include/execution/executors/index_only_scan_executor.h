@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_executor.h
+//
+// Identification: src/include/execution/executors/index_only_scan_executor.h
+//
+// Copyright (c) 2015-20, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_only_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexOnlyScanExecutor executes a scan of an index that covers the query. The tuples are built from the key and
+ * included columns in the leaves of the index, their table is never read.
+ *
+ * Init scans the whole key range and keeps the tuples that pass the predicate, so that no latch on the index is held
+ * between calls to Next.
+ */
+class IndexOnlyScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index-only scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the index-only scan plan to be executed
+   */
+  IndexOnlyScanExecutor(ExecutorContext *exec_ctx, const IndexOnlyScanPlanNode *plan);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+ private:
+  /** The index-only scan plan node to be executed. */
+  const IndexOnlyScanPlanNode *plan_;
+  /** The output tuples with the record ids they come from, and the next one to return. */
+  std::vector<std::pair<Tuple, RID>> results_;
+  size_t next_{0};
+};
+}  // namespace bustub
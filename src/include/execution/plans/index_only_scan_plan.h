@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_only_scan_plan.h
+//
+// Identification: src/include/execution/plans/index_only_scan_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "catalog/catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * IndexOnlyScanPlanNode identifies an index whose key and included columns cover a query, so that the query is
+ * answered from the index alone. The predicate and the output expressions refer to the covered schema of the index,
+ * the key columns followed by the included columns (see IndexMetadata::GetCoveredSchema).
+ */
+class IndexOnlyScanPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new index-only scan plan node.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
+   * nullptr
+   * @param index_oid the identifier of the index to be scanned
+   * @param low_key the smallest key to scan, or nullptr to start at the first key
+   * @param high_key the key to stop before, or nullptr to scan to the last key
+   */
+  IndexOnlyScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                        const Tuple *low_key = nullptr, const Tuple *high_key = nullptr)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        low_key_(low_key),
+        high_key_(high_key) {}
+
+  PlanType GetType() const override { return PlanType::IndexOnlyScan; }
+
+  /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
+  const AbstractExpression *GetPredicate() const { return predicate_; }
+
+  /** @return the identifier of the index that should be scanned */
+  index_oid_t GetIndexOid() const { return index_oid_; }
+
+  /** @return the key tuple to start at, nullptr for the first key */
+  const Tuple *GetLowKey() const { return low_key_; }
+
+  /** @return the key tuple to stop before, nullptr for no bound */
+  const Tuple *GetHighKey() const { return high_key_; }
+
+ private:
+  /** The predicate that all returned tuples must satisfy. */
+  const AbstractExpression *predicate_;
+  /** The index whose entries should be scanned. */
+  index_oid_t index_oid_;
+  /** The range of keys to scan, [low_key_, high_key_). */
+  const Tuple *low_key_;
+  const Tuple *high_key_;
+};
+
+}  // namespace bustub
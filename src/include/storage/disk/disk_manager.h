@@ -15,7 +15,10 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 
@@ -24,42 +27,69 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * A database file is either plain or compressed. A plain file stores page i at offset i * PAGE_SIZE. A compressed file
+ * stores every page image through PageCompressor in a variable-sized slot, and an in-memory indirection map translates
+ * page ids to slots. Each slot starts with a SlotHeader so that the map can be rebuilt by scanning the file on open.
+ *
+ * Compressed slot format (size in byte):
+ *  ---------------------------------------------------------------------------------
+ * | PageId (4) | Size (4) | Capacity (4) | Version (4) | Payload (Capacity bytes)  |
+ *  ---------------------------------------------------------------------------------
+ * Size == PAGE_SIZE means the page did not compress and the payload is the raw page image.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param enable_compression true if pages of this file are stored compressed in variable-sized slots
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool enable_compression = false);
 
-  ~DiskManager() = default;
+  virtual ~DiskManager() = default;
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a run of pages with consecutive ids in one I/O.
+   * @param first_page_id id of the first page
+   * @param page_data raw data of num_pages pages, back to back
+   * @param num_pages number of pages in the run
+   */
+  virtual void WritePages(page_id_t first_page_id, const char *page_data, int num_pages);
+
+  /**
+   * Read a run of pages with consecutive ids in one I/O.
+   * @param first_page_id id of the first page
+   * @param[out] page_data output buffer of num_pages pages
+   * @param num_pages number of pages in the run
+   */
+  virtual void ReadPages(page_id_t first_page_id, char *page_data, int num_pages);
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,7 +98,7 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  virtual bool ReadLog(char *log_data, int size, int offset);
 
   /**
    * Allocate a page on disk.
@@ -80,7 +110,7 @@ class DiskManager {
    * Deallocate a page on disk.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(page_id_t page_id);
+  virtual void DeallocatePage(page_id_t page_id);
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -91,6 +121,12 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of page bytes written to the database file, after compression */
+  uint64_t GetNumBytesWritten() const;
+
+  /** @return true if pages of this file are stored compressed */
+  bool IsCompressed() const { return compressed_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -100,19 +136,64 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without any backing file, for implementations that keep pages elsewhere.
+   */
+  DiskManager();
+
+  std::atomic<page_id_t> next_page_id_;
+  int num_flushes_;
+  int num_writes_;
+  bool flush_log_;
+  std::future<void> *flush_log_f_;
+  uint64_t num_bytes_written_;
+
  private:
+  /** Granularity of compressed slots. Slot footprints (header + payload) are multiples of this. */
+  static constexpr uint32_t SLOT_ALIGNMENT = 256;
+
+  /** On-disk header in front of each compressed slot. */
+  struct SlotHeader {
+    page_id_t page_id_;
+    uint32_t size_;
+    uint32_t capacity_;
+    uint32_t version_;
+  };
+
+  /** Location of a page inside a compressed file. */
+  struct PageSlot {
+    size_t offset_;
+    uint32_t size_;
+    uint32_t capacity_;
+  };
+
   int GetFileSize(const std::string &file_name);
+
+  void WriteCompressedPage(page_id_t page_id, const char *page_data);
+  void ReadCompressedPage(page_id_t page_id, char *page_data);
+  /** Rebuild page_map_ and free_slots_ by scanning the slot headers of an existing compressed file. */
+  void LoadSlots();
+  /** Find room for a slot of at least capacity payload bytes, reusing a free slot if one is large enough. */
+  size_t AllocateSlot(uint32_t *capacity);
+  /** Mark the slot at offset as free on disk and remember it for reuse. */
+  void FreeSlot(size_t offset, uint32_t capacity);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  bool compressed_;
+  // page id -> slot, only used for compressed files
+  std::unordered_map<page_id_t, PageSlot> page_map_;
+  // capacity -> offsets of free slots, only used for compressed files
+  std::map<uint32_t, std::vector<size_t>> free_slots_;
+  // end of the last slot in a compressed file
+  size_t slots_end_;
+  // version stamped into the next slot written, so that the newest copy of a page wins when the map is rebuilt
+  uint32_t next_version_;
 };
 
 }  // namespace bustub
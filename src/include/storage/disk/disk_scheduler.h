@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Priority classes of disk requests, from the most to the least urgent.
+ */
+enum class IOPriority { FOREGROUND_READ = 0, WAL, FOREGROUND_WRITE, PREFETCH, BACKGROUND_FLUSH };
+
+static constexpr size_t NUM_IO_PRIORITIES = 5;
+
+/**
+ * DiskScheduler sits between the BufferPoolManager and the DiskManager. Requests are queued per priority class and a
+ * single worker thread dispatches them to the DiskManager:
+ *
+ * (1) the most urgent class that has pending requests and is within its rate limit is served first,
+ * (2) page requests of the same kind on consecutive page ids in that class are merged into one larger I/O,
+ * (3) writes are copied into the scheduler on submission, so a later read of a page that is still waiting to be
+ *     written is served from the pending copy and never sees stale data on disk.
+ */
+class DiskScheduler {
+ public:
+  /** Maximum number of pages merged into a single I/O. */
+  static constexpr int MAX_MERGED_PAGES = 16;
+
+  /**
+   * Creates a new DiskScheduler and starts its worker thread.
+   * @param disk_manager the disk manager that performs the actual I/O
+   */
+  explicit DiskScheduler(DiskManager *disk_manager);
+
+  /**
+   * Drains every queued request and stops the worker thread.
+   */
+  ~DiskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * Schedule a page read.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, it must stay valid until the returned future is ready
+   * @param priority priority class of the request
+   * @return a future that becomes ready once page_data holds the page
+   */
+  std::future<void> ScheduleRead(page_id_t page_id, char *page_data,
+                                 IOPriority priority = IOPriority::FOREGROUND_READ);
+
+  /**
+   * Schedule a page write. The data is copied, so the caller may reuse page_data right away.
+   * A write to a page that is still queued replaces the queued data.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param priority priority class of the request
+   * @return a future that becomes ready once the data is on disk
+   */
+  std::future<void> ScheduleWrite(page_id_t page_id, const char *page_data,
+                                  IOPriority priority = IOPriority::FOREGROUND_WRITE);
+
+  /**
+   * Schedule a log write in the WAL class.
+   * @param log_data raw log data, it must stay valid until the returned future is ready
+   * @param size size of the log data
+   * @return a future that becomes ready once the log data is on disk
+   */
+  std::future<void> ScheduleLogWrite(char *log_data, int size);
+
+  /**
+   * Drop any queued write of the page and deallocate it on disk.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Limit how many pages per second a priority class may dispatch.
+   * @param priority the priority class
+   * @param pages_per_second the limit, 0 means unlimited
+   */
+  void SetRateLimit(IOPriority priority, double pages_per_second);
+
+  /** @return number of requests submitted in a priority class */
+  size_t GetNumRequests(IOPriority priority);
+
+  /** @return number of I/Os issued to the disk manager, after merging */
+  size_t GetNumDiskIOs();
+
+  /** Stop dispatching requests until Resume() is called. For test purpose. */
+  void Pause();
+
+  /** Resume dispatching requests. */
+  void Resume();
+
+ private:
+  enum class RequestType { READ, WRITE, LOG };
+
+  struct Request {
+    RequestType type_;
+    IOPriority priority_;
+    page_id_t page_id_;
+    // READ: destination of the page, LOG: the log data
+    char *data_;
+    // WRITE: the copy of the page owned by the scheduler
+    std::unique_ptr<char[]> write_buffer_;
+    int log_size_;
+    std::vector<std::promise<void>> waiters_;
+  };
+
+  /** Token bucket for one priority class. */
+  struct RateLimiter {
+    double pages_per_second_{0};
+    double tokens_{0};
+    std::chrono::steady_clock::time_point last_refill_;
+  };
+
+  void WorkerLoop();
+
+  /** @return true if the class may dispatch now, otherwise sets *retry_at to when it may */
+  bool HasTokens(size_t priority, std::chrono::steady_clock::time_point now,
+                 std::chrono::steady_clock::time_point *retry_at);
+
+  /** Remove the front request of a queue together with the requests it can be merged with, ordered by page id. */
+  std::vector<std::shared_ptr<Request>> TakeBatch(std::deque<std::shared_ptr<Request>> *queue);
+
+  /** Perform the I/O of a batch. Called without holding latch_. */
+  void Dispatch(const std::vector<std::shared_ptr<Request>> &batch);
+
+  /** Remove a request from the queue of its priority class. */
+  void RemoveFromQueue(const std::shared_ptr<Request> &request);
+
+  DiskManager *disk_manager_;
+  /** Serializes calls into the disk manager. */
+  std::mutex io_latch_;
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::array<std::deque<std::shared_ptr<Request>>, NUM_IO_PRIORITIES> queues_;
+  std::array<RateLimiter, NUM_IO_PRIORITIES> limiters_;
+  std::array<size_t, NUM_IO_PRIORITIES> num_requests_{};
+  /** Writes waiting in a queue, by page id. */
+  std::unordered_map<page_id_t, std::shared_ptr<Request>> queued_writes_;
+  /** Writes being performed by the worker, by page id. */
+  std::unordered_map<page_id_t, std::shared_ptr<Request>> inflight_writes_;
+  size_t num_disk_ios_{0};
+  bool paused_{false};
+  bool shutdown_{false};
+
+  std::thread worker_;
+};
+
+}  // namespace bustub
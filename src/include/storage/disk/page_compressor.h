@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compressor.h
+//
+// Identification: src/include/storage/disk/page_compressor.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * PageCompressor is a small LZ77-style byte compressor used by the DiskManager to shrink page images before they are
+ * written out. It is tuned for database pages: long runs of zero bytes (unused slots) and repeated key prefixes are
+ * turned into back-references.
+ *
+ * Compressed format is a sequence of (token, literals, match) records:
+ *  ------------------------------------------------------------------------------------------
+ * | Token (1) | LiteralLength+ (0..n) | Literals | MatchOffset (2) | MatchLength+ (0..n) |
+ *  ------------------------------------------------------------------------------------------
+ * The high nibble of the token is the literal length and the low nibble is the match length minus MIN_MATCH. A nibble
+ * of 15 means the length continues in the following bytes (each 255 byte adds 255, the first byte < 255 ends it).
+ * The last record only carries literals.
+ */
+class PageCompressor {
+ public:
+  /** Shortest back-reference that is worth encoding. */
+  static constexpr size_t MIN_MATCH = 4;
+  /** Longest distance a back-reference can reach. */
+  static constexpr size_t MAX_OFFSET = 65535;
+
+  /**
+   * Compress src into dst.
+   * @param src the bytes to compress
+   * @param src_size number of bytes in src
+   * @param[out] dst output buffer
+   * @param dst_capacity size of the output buffer
+   * @return the compressed size, or 0 if the output does not fit in dst_capacity
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress src into dst.
+   * @param src the compressed bytes
+   * @param src_size number of bytes in src
+   * @param[out] dst output buffer
+   * @param dst_size exact size of the uncompressed data
+   * @return true if src was well-formed and expanded to exactly dst_size bytes, false otherwise
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+};
+
+}  // namespace bustub
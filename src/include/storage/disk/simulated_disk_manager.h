@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager.h
+//
+// Identification: src/include/storage/disk/simulated_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Performance characteristics of a simulated device. All times are in microseconds.
+ */
+struct DiskProfile {
+  /** Fixed cost of every read request. */
+  uint64_t read_latency_us_;
+  /** Fixed cost of every write request. */
+  uint64_t write_latency_us_;
+  /** Extra cost of a request that does not start where the previous one ended. */
+  uint64_t seek_latency_us_;
+  /** Transfer rate shared by all requests, in bytes per second. */
+  uint64_t bandwidth_bytes_per_sec_;
+  /** Number of requests the device works on at the same time. */
+  int queue_depth_;
+
+  /** A 7200 rpm hard disk: a seek on every random access and one request at a time. */
+  static DiskProfile Hdd() { return DiskProfile{100, 100, 8000, 150'000'000, 1}; }
+
+  /** A SATA solid state drive. */
+  static DiskProfile SataSsd() { return DiskProfile{90, 30, 0, 550'000'000, 32}; }
+
+  /** An NVMe solid state drive. */
+  static DiskProfile Nvme() { return DiskProfile{20, 10, 0, 3'000'000'000, 64}; }
+};
+
+/**
+ * One request seen by the SimulatedDiskManager.
+ */
+struct DiskAccess {
+  enum class Type { READ, WRITE, LOG_WRITE, LOG_READ };
+
+  Type type_;
+  /** First page of the request, INVALID_PAGE_ID for log requests. */
+  page_id_t page_id_;
+  /** Number of pages in the request, 0 for log requests. */
+  int num_pages_;
+  /** Simulated time the request was issued and completed at. */
+  uint64_t issue_us_;
+  uint64_t complete_us_;
+};
+
+/**
+ * SimulatedDiskManager keeps the database and the log in memory and charges every request the time the configured
+ * device would take, so that buffer pool, read-ahead and flush policies can be measured independently of the host.
+ *
+ * The device serves up to queue_depth requests at the same time. A request waits for a free slot in the queue, pays
+ * its latency (plus a seek if it is not sequential to the previous request), and then transfers its bytes over a
+ * channel of the configured bandwidth that all requests share.
+ *
+ * Time is kept on a simulated clock. By default nothing sleeps: every calling thread has its own clock that advances
+ * by the time its requests take, which makes single threaded runs fully deterministic. With real_time set, each request
+ * is issued at the current wall clock time and the caller sleeps until it completes, so concurrent callers contend for
+ * the device as they would on real hardware.
+ */
+class SimulatedDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new simulated disk.
+   * @param profile performance characteristics of the device
+   * @param real_time true if requests should take real time instead of only advancing the simulated clock
+   */
+  explicit SimulatedDiskManager(const DiskProfile &profile, bool real_time = false);
+
+  ~SimulatedDiskManager() override = default;
+
+  void ShutDown() override {}
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void WritePages(page_id_t first_page_id, const char *page_data, int num_pages) override;
+
+  void ReadPages(page_id_t first_page_id, char *page_data, int num_pages) override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  void DeallocatePage(page_id_t page_id) override;
+
+  /** @return the simulated time when the last request completes, in microseconds */
+  uint64_t GetElapsedTime();
+
+  /** @return the requests performed since the trace was last cleared, in issue order */
+  std::vector<DiskAccess> GetTrace();
+
+  /** Start or stop recording requests. Recording is on by default. */
+  void EnableTrace(bool enable);
+
+  /** Forget the recorded requests. */
+  void ClearTrace();
+
+ private:
+  /**
+   * Charge a request to the simulated device and wait for it if running in real time.
+   * @param type kind of request
+   * @param page_id first page of the request, INVALID_PAGE_ID for log requests
+   * @param num_pages number of pages of the request, 0 for log requests
+   * @param size number of bytes transferred
+   */
+  void Access(DiskAccess::Type type, page_id_t page_id, int num_pages, size_t size);
+
+  /** Simulated time of the calling thread. Called with latch_ held. */
+  uint64_t Now();
+
+  const DiskProfile profile_;
+  const bool real_time_;
+  const std::chrono::steady_clock::time_point start_;
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> pages_;
+  std::vector<char> log_;
+  /** Time each queue slot of the device becomes free. */
+  std::vector<uint64_t> slot_free_us_;
+  /** Time the transfer channel becomes free. */
+  uint64_t channel_free_us_{0};
+  /** Page following the last page request, a request starting there needs no seek. */
+  page_id_t next_sequential_page_{0};
+  /** Simulated clocks of the calling threads, only used when not running in real time. */
+  std::unordered_map<std::thread::id, uint64_t> thread_clocks_;
+  uint64_t elapsed_us_{0};
+  bool trace_enabled_{true};
+  std::vector<DiskAccess> trace_;
+};
+
+}  // namespace bustub
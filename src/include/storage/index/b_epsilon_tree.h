@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_epsilon_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_epsilon_tree_page.h"
+
+namespace bustub {
+
+#define B_EPSILON_TREE_TYPE BEpsilonTree<KeyType, ValueType, KeyComparator>
+
+// children of an internal page by default, about the square root of the messages a page buffers
+#define B_EPSILON_TREE_INTERNAL_SIZE 16
+
+/**
+ * Write-optimized B+ tree with unique keys, after the B-epsilon tree. Every write becomes a message, which is added to
+ * the buffer of the root rather than applied to its leaf. Once the buffer of an internal page is full, the messages
+ * of the child that has the most of them are moved down in one batch, into the buffer of the child or, at the bottom,
+ * into the leaf. A leaf is then read and written once for a whole batch of keys, instead of once per key as in
+ * BPlusTree, at the price of a smaller fanout, since internal pages spend most of their space on the buffer.
+ *
+ * A lookup collects the messages of its key on the way down, which are newer the higher up they are, and applies them
+ * to what the leaf holds.
+ *
+ * Writers hold tree_latch_ exclusively and lookups share it. Pages are never merged; a leaf whose keys are all
+ * deleted stays in the tree empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTree {
+  using InternalPage = BEpsilonTreeInternalPage<KeyType, ValueType, KeyComparator>;
+  using LeafPage = BEpsilonTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using Message = BEpsilonMessage<KeyType, ValueType>;
+
+ public:
+  explicit BEpsilonTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                        int leaf_max_size = LeafPage::Capacity(), int internal_max_size = B_EPSILON_TREE_INTERNAL_SIZE);
+
+  // Returns true if this tree has no pages.
+  bool IsEmpty() const;
+
+  // Give key the value, unless it already has one. Whether it had one is only known once the message reaches its leaf.
+  void Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Give key the value, replacing the one it may have.
+  void Upsert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove key and its value.
+  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key, with the messages still buffered for it applied
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+ private:
+  void AddMessage(const Message &message);
+
+  /**
+   * Move sorted messages into the subtree rooted at page_id: into the buffer of an internal page, flushing the
+   * fullest batches on to its children until the buffer fits, or applied to the pairs of a leaf.
+   * @param[out] siblings the first key and page id of each page the root of the subtree was split into, after it
+   */
+  void ApplyMessages(page_id_t page_id, std::vector<Message> messages,
+                     std::vector<std::pair<KeyType, page_id_t>> *siblings);
+
+  /** Replace the pairs of the leaf, moving those that do not fit to new siblings. */
+  void StoreLeaf(LeafPage *leaf, const std::vector<MappingType> &pairs,
+                 std::vector<std::pair<KeyType, page_id_t>> *siblings);
+
+  /** Replace the contents of the internal page, moving the children that do not fit to new siblings. */
+  void StoreInternal(InternalPage *internal, const std::vector<KeyType> &pivots, const std::vector<page_id_t> &children,
+                     const std::vector<Message> &messages, std::vector<std::pair<KeyType, page_id_t>> *siblings);
+
+  /** Apply a run of messages of the same key, oldest first, to its value. @return whether the key has a value then */
+  static bool Resolve(const Message *begin, const Message *end, bool found, ValueType *value);
+
+  /** Allocate a page for a new node, @return the pinned page */
+  Page *NewPage(page_id_t *page_id);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  ReaderWriterLatch tree_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_epsilon_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "storage/index/b_epsilon_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+#define B_EPSILON_TREE_INDEX_TYPE BEpsilonTreeIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * Write-optimized index on unique keys, for tables that take many more inserts than lookups. Entries are buffered on
+ * their way to the leaves and reach them in batches, see BEpsilonTree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTreeIndex : public Index {
+ public:
+  BEpsilonTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  // point the key at rid, whether it is in the index or not
+  void UpsertEntry(const Tuple &key, RID rid, Transaction *transaction);
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+ protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  BEpsilonTree<KeyType, ValueType, KeyComparator> container_;
+};
+
+}  // namespace bustub
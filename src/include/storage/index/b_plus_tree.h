@@ -10,14 +10,24 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/index_statistics.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
@@ -28,10 +38,54 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is constructed with unique unset
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is safe for concurrent use. Lookups descend with read latches, releasing each parent as soon as the child is
+ * latched. Insert and Remove crab down with write latches, keeping the latched ancestors in the transaction's page set
+ * and releasing all of them as soon as a child is safe, i.e. cannot split or underflow. root_page_id_ is guarded by
+ * root_latch_, which a writer holds until the root itself is known to be safe.
+ *
+ * Since most writes do not change the structure of the tree, Insert and Remove first descend optimistically like a
+ * lookup and write latch only the leaf. Only if the leaf would split or underflow do they give up and restart with the
+ * write latch crabbing above, so that the upper levels are not serialized by every writer.
+ *
+ * Constructed with b_link set, the tree follows Lehman and Yao instead. Every page carries a right link and a high key,
+ * and a page that split is reachable through its right link before its parent knows about it. Nobody latches more than
+ * one page on the way down: a lookup or write that lands on a page whose high key is not above its key moves right.
+ * A writer only latches its leaf, and when the leaf splits it goes back up along the recorded path, holding at most
+ * the split page, its parent and the parent's right sibling. Pages are never merged or freed in this mode, so that a
+ * page id read without a latch stays valid, and parent page ids are not maintained.
+ *
+ * Constructed with compress set, which needs keys that compare bytewise like NormalizedKey, pages store their keys
+ * without the prefix their fences share (see KeyPrefix). The deeper a page is, the closer its fences and the longer
+ * the prefix, so that more pairs fit. The max sizes passed in are then upper limits, and each page holds as many pairs
+ * as fit with its current prefix. Since that number shrinks when the fences of a page widen, pages are only merged
+ * or given a pair of their sibling if the result fits; otherwise an underfull page is left as it is.
+ *
+ * Constructed with unique unset, a key may have any number of values. The pairs of a key are kept next to each other
+ * in the same leaf, sorted by value, and leaves only split between two keys. Once a key has more values than
+ * max_inline_values_, they move to a posting list, a chain of BPlusTreePostingPage, and the leaf keeps a single pair
+ * for the key that refers to it. Either way all values of a key are found with one descent and read sequentially.
+ *
+ * A page underflows, and is merged with or given pairs by its sibling, once it is less than merge_threshold full. The
+ * usual threshold of one half makes a page that sits at the boundary split and merge over and over when inserts and
+ * deletes alternate. A lower threshold leaves more room between the two, and removals rarely have to restructure the
+ * tree; the leaves that end up sparse are merged later by Compact, which StartCompaction runs in the background
+ * whenever the tree is idle.
+ *
+ * PinTopLevels keeps the internal pages of the upper levels pinned, where every descent passes, so that they are never
+ * evicted, and lookups find them in a snapshot of their own instead of the page table of the buffer pool. The
+ * snapshot is rebuilt by the next lookup after the upper levels change shape.
+ *
+ * Rebuild replaces a tree that churn has left sparse and scattered with a compact copy, holding up writers only for a
+ * moment. While it runs, writers note the keys they changed in a side log. The copy is bulk loaded from a scan that
+ * reads one leaf at a time, and then catches up by taking over the current values of the logged keys: in rounds while
+ * writers go on, and for the last few keys with writers held off by rebuild_latch_, under which root_page_id_ moves to
+ * the copy. The old pages are freed top down afterwards, once the readers that started before the swap are done, see
+ * Generation.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,25 +94,91 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool b_link = false, bool compress = false, bool unique = true, double merge_threshold = 0.5);
+
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree, false if the key (the pair, if keys are not unique) is already there.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all of its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a single key-value pair from this B+ tree.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  /**
+   * Build the empty tree bottom-up from key & value pairs in increasing key order, instead of inserting them one at a
+   * time. Leaves are packed to the fill factor and allocated one after another, followed by each internal level in
+   * turn. As with Insert, only the first pair of equal keys is kept, or of equal pairs if keys are not unique; the
+   * values of a key then have to come in increasing order. The tree is invisible to other operations until it is
+   * complete.
+   * @param next produces the next pair, returns false at the end of the input
+   * @param fill_factor fraction of each page to fill, in (0, 1]
+   * @return false if the tree was not empty
+   */
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
+  /**
+   * Merge each leaf that is less than half full into a sibling, if the two fit into one leaf. Merged pages underflow
+   * parents as usual, with respect to the merge threshold. Pages are never merged in B-link mode.
+   * @return the number of leaves merged away
+   */
+  int Compact();
+
+  /**
+   * Rebuild the tree online, see above. The copy has its pages filled to fill_factor, and its leaves allocated one
+   * after another so that range scans read them sequentially.
+   * @return false in B-link mode, or if another rebuild is running
+   */
+  bool Rebuild(double fill_factor = 1.0);
+
+  // run Compact in a background thread every compaction_interval in which no insertion or removal came in
+  void StartCompaction();
+  void StopCompaction();
+
+  /**
+   * Keep the internal pages of the top levels of the tree, the root being the first level, pinned in the buffer pool,
+   * for lookups to reach without the page table. At most a quarter of the pool is pinned this way. Not in B-link mode.
+   * The pages have to be released, with levels 0, before the buffer pool is deleted.
+   */
+  void PinTopLevels(int levels);
+
+  // return the values associated with a given key, in increasing order if keys are not unique
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Look up a batch of keys, appending the values of keys[i] to (*results)[i]. The keys have to be sorted, so that
+   * consecutive keys of the same leaf are all looked up under one latch on it, and a key of the next leaf is reached
+   * through the sibling pointer instead of from the root. Each leaf is then visited at most once.
+   * @return the number of keys found
+   */
+  int GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                Transaction *transaction = nullptr);
+
+  /**
+   * Feed the collector the height of the tree, then the leaves from left to right with their keys, latching one leaf
+   * at a time as an iterator does.
+   * @param first_column decodes the first column of a key for the histogram, empty if keys cannot be decoded
+   */
+  void CollectStatistics(IndexStatisticsCollector *collector,
+                         const std::function<Value(const KeyType &)> &first_column);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // reverse index iterator, from the largest key down; it ends at end() as well
+  INDEXITERATOR_TYPE rbegin();
+
+  // index iterator over the keys in [low, high), in decreasing order if reverse is set
+  INDEXITERATOR_TYPE Range(const KeyType &low, const KeyType &high, bool reverse = false);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -76,22 +196,238 @@ class BPlusTree {
 
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
-  // expose for test purpose
+  // expose for test purpose, the leaf is returned pinned and read latched
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  // a reverse iterator descends the tree to step from one leaf to the one before it
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  // COMPACT descends to a leaf that is to be merged with its sibling
+  enum class Operation { READ, INSERT, DELETE, COMPACT };
+
+  /**
+   * Pages freed while something still pinned them: a snapshot of pinned pages, which lookups may hold older than the
+   * current one, or a reader on its way through. Each snapshot retries the deletes once it has unpinned its pages, and
+   * so do the operations that free pages, and the tree once it is destroyed, for the pages no snapshot pinned.
+   */
+  struct FreedPages {
+    /** Delete the pages that nothing pins any more. */
+    void Retry(BufferPoolManager *buffer_pool_manager);
+
+    std::mutex latch_;
+    std::vector<page_id_t> page_ids_;
+  };
+
+  /**
+   * Snapshot of the pinned top levels, each page pinned once for as long as the snapshot lives. A lookup takes the
+   * current snapshot before it starts, so that the pages it finds there stay pinned until it is done. A page that is
+   * freed while a snapshot pins it is deleted along with the last such snapshot, see FreedPages.
+   */
+  struct PinnedPages {
+    PinnedPages(BufferPoolManager *buffer_pool_manager, FreedPages *freed)
+        : buffer_pool_manager_(buffer_pool_manager), freed_(freed) {}
+    ~PinnedPages();
+    Page *Find(page_id_t page_id) const {
+      auto it = pages_.find(page_id);
+      return it == pages_.end() ? nullptr : it->second;
+    }
+
+    BufferPoolManager *buffer_pool_manager_;
+    FreedPages *freed_;
+    std::unordered_map<page_id_t, Page *> pages_;
+  };
+
+  /**
+   * The readers of the pages of the tree between two rebuilds. Iterators and lookups that move from leaf to leaf hold
+   * the current generation for as long as they are on its pages; a rebuild starts the next one once the copy is in
+   * place, and the pages it replaced are freed along with the generation before, by the last reader to let go of it.
+   * Those readers may move on into the copy, so a generation also keeps the next one alive.
+   */
+  struct Generation {
+    explicit Generation(BPlusTree *tree) : tree_(tree) {}
+    ~Generation();
+
+    BPlusTree *tree_;
+    // the root of the pages replaced by the rebuild that ended the generation
+    page_id_t retired_root_page_id_{INVALID_PAGE_ID};
+    std::shared_ptr<Generation> next_;
+  };
+
+  /** @return the current generation, to hold while on the pages of the tree */
+  std::shared_ptr<Generation> EnterGeneration() { return std::atomic_load(&generation_); }
+
+  /** @return the current snapshot of pinned pages, rebuilt first if it is stale, or nullptr if there is none */
+  std::shared_ptr<PinnedPages> GetPinnedPages();
+
+  /** Pin the internal pages of the top pinned_levels_ levels, crabbing down with read latches, as the new snapshot. */
+  void RefreshPinnedPages();
+
+  /** Fetch a page on the way down, from the snapshot if it holds the page and from the buffer pool otherwise. */
+  Page *FetchPage(page_id_t page_id, const PinnedPages *pinned);
+
+  /** Unpin a clean page fetched with FetchPage, unless the snapshot keeps it pinned. */
+  void UnpinPage(Page *page, const PinnedPages *pinned);
+
+  /**
+   * Descend to the leaf that may hold key, latch crabbing on the way. Read operations only keep the returned leaf
+   * latched. Write operations keep every page that may still be modified, and root_latch_ while the root may change,
+   * in the transaction's page set (root_latch_ is represented by nullptr).
+   * @return the pinned and latched leaf, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageByOperation(const KeyType &key, Operation op, Transaction *transaction, bool left_most = false);
+
+  /**
+   * Descend to the leaf that may hold key with read latches only, and write latch the leaf. Insert and Remove try this
+   * first and fall back to FindLeafPageByOperation when the leaf turns out not to be safe.
+   * @return the pinned and write latched leaf, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageOptimistic(const KeyType &key);
+
+  /** @return true if the operation, on count pairs of a leaf, cannot propagate from node to its parent */
+  bool IsSafe(BPlusTreePage *node, Operation op, int count = 1);
+
+  /** @return the size below which node underflows, according to the merge threshold */
+  int MinSize(BPlusTreePage *node) const;
+
+  /** Unlatch and unpin every page in the transaction's page set, and release root_latch_ if it is held. */
+  void ReleaseLatchedPages(Transaction *transaction, bool is_dirty);
+
+  /** Delete the pages that were emptied by the operation, once nothing latches them any more. */
+  void DeletePages(Transaction *transaction);
+
+  /**
+   * Descend to the leaf that may hold key in B-link mode, latching one page at a time and moving right past pages
+   * that split since their parent was read.
+   * @param path if not null, receives the internal pages the descent went through, from the root down
+   * @return the pinned leaf, write latched unless op is READ, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageBLink(const KeyType &key, Operation op, std::vector<page_id_t> *path = nullptr,
+                          bool left_most = false);
+
+  /**
+   * Follow right links from the latched page until reaching the page whose key range holds key, the keys right
+   * before key if before is set, or the rightmost page of the level if right_most is set. Each page is latched before
+   * the one to its left is released.
+   * @return the pinned and latched page to continue with
+   */
+  Page *MoveRight(Page *page, const KeyType &key, bool exclusive, bool before = false, bool right_most = false);
+
+  /**
+   * Descend with read latches to the leaf whose key range holds the keys right before key, or to the rightmost leaf
+   * if right_most is set. This is where a reverse scan goes on once it has returned all keys from key on; leaves keep
+   * no links to their left siblings, since keeping those exact would have writers latch pages to the right of their
+   * leaf, against the order merges latch siblings in. *left_most is set to whether the leaf is the first one, which
+   * stays so while it is latched.
+   * @return the pinned and read latched leaf, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageBefore(const KeyType &key, bool right_most, bool *left_most);
+
+  /**
+   * Search the tree from the root for the parent of a page, for a split that did not record the parent on its way down
+   * because the page was the root at the time.
+   * @param key a key in the range of the child page
+   * @return the internal page that points to child_page_id
+   */
+  page_id_t FindParentBLink(page_id_t child_page_id, const KeyType &key);
+
+  bool InsertBLink(const KeyType &key, const ValueType &value);
+
+  void InsertIntoParentBLink(Page *page, KeyType key, page_id_t new_page_id, std::vector<page_id_t> *path);
+
+  void RemoveBLink(const KeyType &key, const ValueType *value);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  /** Body of Insert, which holds rebuild_latch_ around it. */
+  bool InsertEntry(const KeyType &key, const ValueType &value, Transaction *transaction);
+
+  /** Note a key a writer changed in the side log, if a rebuild is running. Called with rebuild_latch_ held. */
+  void LogRebuildKey(const KeyType &key);
+
+  /** Give the keys in copy the values they have in this tree now, the keys are consumed. */
+  void CatchUp(BPlusTree *copy, std::vector<KeyType> *keys);
+
+  /**
+   * Free the pages of a tree that new operations cannot reach any more, level by level from the root and each level
+   * from left to right, the order readers move in. Each page is write latched first, so that the readers still on it
+   * have moved on to pages that are freed later.
+   */
+  void FreeTree(page_id_t root_page_id);
+
+  /** Delete a freed page, or queue it in freed_pages_ if it is still pinned. */
+  void FreePage(page_id_t page_id);
+
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  enum class LeafChange { NONE, DONE, NOT_SAFE };
+
+  /**
+   * Insert a pair into the latched leaf that holds the range of key.
+   * @param only_if_safe if set, give up rather than let the leaf reach max size
+   * @return NONE if the pair is a duplicate, DONE if it was inserted, NOT_SAFE if the leaf would have to split
+   */
+  LeafChange InsertIntoPage(LeafPage *leaf, const KeyType &key, const ValueType &value, bool only_if_safe);
+
+  /**
+   * Remove the pairs of a key, or only the one with *value if value is not null, from the latched leaf.
+   * @param only_if_safe if set, give up rather than let the leaf underflow
+   * @return NONE if there was no such pair, DONE if it was removed, NOT_SAFE if the leaf would underflow
+   */
+  LeafChange RemoveFromPage(LeafPage *leaf, const KeyType &key, const ValueType *value, bool only_if_safe);
+
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  /** Append the values of key in the latched leaf to result, @return false if there are none */
+  bool GetValuesFromPage(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Move a batched lookup on from its read latched leaf to the next one, if key belongs there.
+   * @return the read latched next leaf, or nullptr if key lies further on, with the leaf released either way
+   */
+  Page *MoveToNextLeaf(Page *page, const KeyType &key);
+
+  /* Posting lists of non-unique keys, they are latched by the leaf that refers to them */
+  BPlusTreePostingPage *FetchPostingPage(page_id_t page_id);
+
+  /** @return the first page of a new posting list holding the sorted values */
+  page_id_t CreatePostingList(const std::vector<ValueType> &values);
+
+  /** @return false if value is already in the posting list */
+  bool InsertIntoPostingList(page_id_t page_id, const ValueType &value);
+
+  /**
+   * Remove value from the posting list the pair at index of the leaf refers to. The pair is updated when the first
+   * page of the list is freed, and gets the last value back when only one is left.
+   * @return false if value is not in the posting list
+   */
+  bool RemoveFromPostingList(LeafPage *leaf, int index, const ValueType &value);
+
+  void AppendPostingList(page_id_t page_id, std::vector<ValueType> *result);
+
+  void DeletePostingList(page_id_t page_id);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
   template <typename N>
   N *Split(N *node);
 
+  /**
+   * Merge node with or refill it from its sibling if node underflows. With compact set, node is merged if it is less
+   * than half full and fits into its sibling, and left as it is otherwise.
+   */
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr, bool compact = false);
+
+  /**
+   * Merge the leaf that holds key, or the leftmost leaf, with its sibling if it is less than half full.
+   * @return true if a leaf was merged away
+   */
+  bool CompactLeaf(const KeyType &key, bool left_most, Transaction *transaction);
+
+  // body of the background compaction thread
+  void RunCompaction();
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
@@ -116,6 +452,34 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool b_link_;
+  bool compress_;
+  bool unique_;
+  // a key with more values moves them to a posting list
+  int max_inline_values_;
+  ReaderWriterLatch root_latch_;
+  // pages underflow below this fraction of their max size
+  double merge_threshold_;
+  // insertions and removals so far, counted only while compaction runs, which waits for the count to stay put
+  std::atomic<uint64_t> write_count_{0};
+  std::atomic<bool> enable_compaction_{false};
+  std::thread compaction_thread_;
+  // levels pinned by PinTopLevels, and the snapshot of them, only ever replaced as a whole with std::atomic_store
+  std::atomic<int> pinned_levels_{0};
+  // outlives every snapshot, which are destroyed before it
+  FreedPages freed_pages_;
+  std::shared_ptr<PinnedPages> pinned_pages_;
+  // set when a new root, a split or a merge changes the pinned levels
+  std::atomic<bool> pinned_pages_stale_{false};
+  // shared by writers, taken exclusively by Rebuild to start the side log and to swap in the copy
+  ReaderWriterLatch rebuild_latch_;
+  bool rebuilding_{false};
+  std::mutex rebuild_log_latch_;
+  std::vector<KeyType> rebuild_log_;
+  // only ever replaced with std::atomic_exchange
+  std::shared_ptr<Generation> generation_{std::make_shared<Generation>(this)};
+  // unset for the copy a rebuild builds, which must not take over the header page record of the tree
+  bool persist_root_{true};
 };
 
 }  // namespace bustub
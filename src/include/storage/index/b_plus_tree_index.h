@@ -13,9 +13,11 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/covering_value.h"
 #include "storage/index/index.h"
 
 namespace bustub {
@@ -29,16 +31,53 @@ class BPlusTreeIndex : public Index {
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  // with a CoveringValue as ValueType, the included columns are stored in the leaf along with the record id
+  void InsertEntry(const Tuple &key, const Tuple &included, RID rid, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  // supported with GenericKey keys and a CoveringValue as ValueType, the leaves hold all columns then
+  void ScanRange(const Tuple *low, const Tuple *high, const std::function<bool(const Tuple &, RID)> &callback,
+                 Transaction *transaction) override;
+
+  // probes the tree with the keys in sorted order, visiting each leaf at most once
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  // the histogram needs GenericKey keys, which can be decoded
+  IndexStatistics CollectStatistics(Transaction *transaction) override;
+
+  /**
+   * Fill the empty index bottom-up.
+   * @param entries keys and their values, sorted by key
+   * @param fill_factor fraction of each index page to fill
+   * @return false if the index was not empty
+   */
+  bool BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries, double fill_factor = 1.0);
+
+  /**
+   * Fill the empty index bottom-up from several sorted runs, merging them as they are loaded. Of pairs with equal keys
+   * an earlier run is taken first, in record id order if keys are not unique.
+   * @param runs keys and their values, each run sorted by key (and by record id if keys are not unique)
+   * @param fill_factor fraction of each index page to fill
+   * @return false if the index was not empty
+   */
+  bool BulkLoad(const std::vector<std::vector<std::pair<KeyType, ValueType>>> &runs, double fill_factor = 1.0);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  // iterates from the largest key down, for descending order
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  // iterates over the keys in [low, high), in descending order if reverse is set
+  INDEXITERATOR_TYPE GetRangeIterator(const KeyType &low, const KeyType &high, bool reverse = false);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// covering_value.h
+//
+// Identification: src/include/storage/index/covering_value.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "common/macros.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Value of the leaf pairs of an index with included columns (see IndexMetadata::GetIncludeAttrs). It holds the
+ * record id of the tuple followed by its included columns, serialized like a GenericKey, so that an index-only scan
+ * can produce them from the leaf without fetching the tuple from its table.
+ *
+ * A CoveringValue converts from and to its record id, and two of them are equal if their record ids are. Then it
+ * stands in for a record id where the tree deals with those, but posting lists only keep the record id, so an index
+ * with included columns has to have unique keys.
+ */
+template <size_t PayloadSize>
+class CoveringValue {
+ public:
+  CoveringValue() = default;
+
+  // NOLINTNEXTLINE
+  CoveringValue(const RID &rid) : rid_(rid) { memset(data_, 0, PayloadSize); }
+
+  // NOLINTNEXTLINE
+  operator RID() const { return rid_; }
+
+  inline RID GetRid() const { return rid_; }
+
+  /** Store the included columns, a tuple of the include schema. */
+  inline void SetFromTuple(const Tuple &included) {
+    BUSTUB_ASSERT(included.GetLength() <= PayloadSize, "Included columns do not fit into the payload");
+    memset(data_, 0, PayloadSize);
+    memcpy(data_, included.GetData(), included.GetLength());
+  }
+
+  inline Value ToValue(const Schema *schema, uint32_t column_idx) const {
+    const char *data_ptr;
+    const auto &col = schema->GetColumn(column_idx);
+    if (col.IsInlined()) {
+      data_ptr = data_ + col.GetOffset();
+    } else {
+      int32_t offset = *reinterpret_cast<const int32_t *>(data_ + col.GetOffset());
+      data_ptr = data_ + offset;
+    }
+    return Value::DeserializeFrom(data_ptr, col.GetType());
+  }
+
+  bool operator==(const CoveringValue &other) const { return rid_ == other.rid_; }
+
+ private:
+  RID rid_;
+  char data_[PayloadSize];
+};
+
+}  // namespace bustub
@@ -13,6 +13,8 @@
 #pragma once
 
 #include <cstring>
+#include <type_traits>
+#include <utility>
 
 #include "storage/table/tuple.h"
 #include "type/value.h"
@@ -35,6 +37,9 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // the key tuple is kept as it is, only key types that encode it need the schema
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -103,4 +108,15 @@ class GenericComparator {
   Schema *key_schema_;
 };
 
+/**
+ * True if the key type can give back the values of its columns, as GenericKey can, which index-only scans and index
+ * statistics read them from.
+ */
+template <typename KeyType, typename = void>
+struct HasToValue : std::false_type {};
+
+template <typename KeyType>
+struct HasToValue<KeyType, std::void_t<decltype(std::declval<const KeyType &>().ToValue(nullptr, 0))>>
+    : std::true_type {};
+
 }  // namespace bustub
@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/index_statistics.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -37,12 +42,24 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool unique = true, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)),
+        unique_(unique) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    include_schema_ = Schema::CopySchema(tuple_schema, include_attrs_);
+    std::vector<uint32_t> covered_attrs(key_attrs_);
+    covered_attrs.insert(covered_attrs.end(), include_attrs_.begin(), include_attrs_.end());
+    covered_schema_ = Schema::CopySchema(tuple_schema, covered_attrs);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    delete key_schema_;
+    delete include_schema_;
+    delete covered_schema_;
+  }
 
   inline const std::string &GetName() const { return name_; }
 
@@ -60,6 +77,18 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns false if several tuples may have the same key
+  inline bool IsUnique() const { return unique_; }
+
+  // Returns the columns of the base table that the index stores along with each key, to be read without the tuple
+  inline const std::vector<uint32_t> &GetIncludeAttrs() const { return include_attrs_; }
+
+  // Returns the schema of the included columns
+  inline Schema *GetIncludeSchema() const { return include_schema_; }
+
+  // Returns the schema of what an index-only scan produces, the key columns followed by the included columns
+  inline Schema *GetCoveredSchema() const { return covered_schema_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -78,8 +107,15 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // The columns stored in the leaves along with the keys
+  const std::vector<uint32_t> include_attrs_;
+  // whether a key identifies a single tuple
+  bool unique_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of the included columns, and of the key and included columns together
+  Schema *include_schema_;
+  Schema *covered_schema_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -117,6 +153,10 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  Schema *GetIncludeSchema() const { return metadata_->GetIncludeSchema(); }
+
+  const std::vector<uint32_t> &GetIncludeAttrs() const { return metadata_->GetIncludeAttrs(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -135,13 +175,56 @@ class Index {
   // delete the index entry linked to given tuple
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  // insert an entry of an index with included columns, which come in the order of the include schema
+  virtual void InsertEntry(const Tuple &key, const Tuple &included, RID rid, Transaction *transaction) {
+    InsertEntry(key, rid, transaction);
+  }
+
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Scan the entries whose keys lie in [low, high) in key order, for an index-only scan. Each entry is handed to the
+   * callback as a tuple of the covered schema, the key columns followed by the included columns, together with its
+   * record id. The scan stops early once the callback returns false.
+   * @param low the first key to scan, or nullptr to start at the smallest key
+   * @param high the key to stop at, or nullptr to scan to the end
+   */
+  virtual void ScanRange(const Tuple *low, const Tuple *high, const std::function<bool(const Tuple &, RID)> &callback,
+                         Transaction *transaction) {
+    throw NotImplementedException("Index does not support index-only scans");
+  }
+
+  // look up several keys at once, appending the tuples of keys[i] to (*results)[i]; indexes that can share work
+  // between the lookups, such as a probe per outer tuple of an index join, override this
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Gather statistics over the whole index in one pass, see IndexStatistics. Writers are not held up meanwhile, so
+   * the statistics describe the index as the pass found each of its pages.
+   */
+  virtual IndexStatistics CollectStatistics(Transaction *transaction) {
+    throw NotImplementedException("Index does not collect statistics");
+  }
+
+  /** @return the entries inserted and deleted so far, which tell how far the index drifted from its statistics */
+  uint64_t GetModificationCount() const { return modifications_.load(); }
+
+ protected:
+  // count an inserted or deleted entry, done by InsertEntry and DeleteEntry of every index
+  void CountModification() { modifications_.fetch_add(1); }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
   //===--------------------------------------------------------------------===//
   IndexMetadata *metadata_;
+  std::atomic<uint64_t> modifications_{0};
 };
 
 }  // namespace bustub
@@ -13,31 +13,117 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class BPlusTree;
+
+/**
+ * Iterates over the key & value pairs of a B+ tree in key order, increasing or, for a reverse iterator, decreasing.
+ * The iterator keeps the leaf it points into pinned and read latched, and moves on to the next leaf through the
+ * sibling pointer. Leaves are not linked to the left, so a reverse iterator descends the tree again to the leaf
+ * before the current one. A bounded iterator ends by itself at its bound, the first key not to return. In a tree with
+ * non-unique keys, a pair that refers to a posting list stands for all of its values, which the iterator returns one
+ * by one, pinning one posting page at a time; a reverse iterator copies the values of the posting list instead, since
+ * its pages are only linked to the right. The iterator holds the generation of the tree it started in, so that a
+ * rebuild does not free the pages it walks, see BPlusTree::Generation.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
+  /**
+   * @param tree the tree to iterate over
+   * @param generation the generation of the tree, entered before the leaf was found
+   * @param page leaf page, pinned and read latched; the iterator takes over both, nullptr for the end iterator
+   * @param index position in the leaf, which may be one past either end of it
+   * @param reverse whether to iterate in decreasing key order
+   * @param left_most whether the leaf is the first one, which a reverse iterator needs to know
+   * @param bound if not null, the iterator ends before the first key not less than *bound, or for a reverse iterator
+   * after the last key not less than *bound
+   */
+  IndexIterator(Tree *tree, std::shared_ptr<void> generation, Page *page, int index, bool reverse = false,
+                bool left_most = false, const KeyType *bound = nullptr);
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
   ~IndexIterator();
 
+  DISALLOW_COPY(IndexIterator);
+
   bool isEnd();
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /**
+   * Append up to max_count pairs to batch and move past them, taking them from the current leaf only so that its
+   * latch is held once for all of them.
+   * @return the number of pairs appended, zero only at the end
+   */
+  int NextBatch(std::vector<MappingType> *batch, int max_count);
+
+  bool operator==(const IndexIterator &itr) const {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_->GetPageId() == itr.page_->GetPageId() && index_ == itr.index_ &&
+           posting_page_id_ == itr.posting_page_id_ && posting_index_ == itr.posting_index_;
+  }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Skip to the following leaves while index_ is past the end of the current one. */
+  void SkipExhaustedLeaves();
+
+  /** Skip to the preceding leaves while index_ is before the start of the current one. */
+  void SkipExhaustedLeavesBackward();
+
+  /** End the iteration if the current key is past the bound. */
+  void CheckBound();
+
+  /** Move into the posting list the current pair refers to, if any. */
+  void EnterPostingList();
+
+  /** Unpin the current posting page. */
+  void ReleasePostingPage();
+
+  /** Unlatch and unpin the current leaf. */
+  void Release();
+
+  Tree *tree_{nullptr};
+  std::shared_ptr<void> generation_;
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  bool postings_{false};
+  bool reverse_{false};
+  bool left_most_{false};
+  bool bounded_{false};
+  KeyType bound_;
+  // the posting page and position in it while the current pair refers to a posting list
+  page_id_t posting_page_id_{INVALID_PAGE_ID};
+  BPlusTreePostingPage *posting_{nullptr};
+  int posting_index_{0};
+  // the values of the current posting list, for a reverse iterator
+  std::vector<ValueType> posting_values_;
+  // a compressed leaf does not store its pairs whole, operator* returns a copy that lives here
+  MappingType item_;
 };
 
 }  // namespace bustub
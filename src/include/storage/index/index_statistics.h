@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_statistics.h
+//
+// Identification: src/include/storage/index/index_statistics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * HyperLogLog sketch of the number of distinct items in a stream, after Flajolet et al. The top precision bits of the
+ * hash of an item pick one of 2^precision registers, which keeps the longest run of leading zeros seen in the rest of
+ * the hash, plus one. The harmonic mean of the registers estimates the count to within about 1.04 / sqrt(registers),
+ * 1.6% with the default 4096 one-byte registers.
+ */
+class HyperLogLog {
+ public:
+  explicit HyperLogLog(uint32_t precision = 12);
+
+  void Add(uint64_t hash);
+
+  // fold in the items of another sketch of the same precision
+  void Merge(const HyperLogLog &other);
+
+  uint64_t Estimate() const;
+
+ private:
+  uint32_t precision_;
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * Size, shape and key distribution of an index, as gathered by IndexStatisticsCollector. The catalog keeps them with
+ * the index (see Catalog::AnalyzeIndex), to estimate how many entries a scan of the index returns.
+ */
+struct IndexStatistics {
+  // entries, a key with several values counts once per value
+  uint64_t num_entries_{0};
+  // leaves of a tree, blocks of a hash table
+  uint64_t num_pages_{0};
+  // levels from the root down to the leaves, 1 for a hash table, 0 if the index is empty
+  uint32_t height_{0};
+  // average fraction of the slots of those pages in use
+  double fill_factor_{0};
+  // estimated number of distinct keys
+  uint64_t distinct_keys_{0};
+  // equi-depth histogram of the first key column: about the same number of entries lie between each two consecutive
+  // bounds, the first bound is the smallest value and the last the largest. Empty if the keys cannot be decoded
+  std::vector<Value> histogram_bounds_;
+
+  /** @return the estimated fraction of the entries whose first key column lies in [low, high) */
+  double EstimateRangeFraction(const Value &low, const Value &high) const;
+
+  /** @return the estimated fraction of the entries with a given key */
+  double EstimateEqualFraction() const { return distinct_keys_ == 0 ? 0 : 1.0 / distinct_keys_; }
+
+ private:
+  /** @return the estimated fraction of the entries whose first key column is less than value */
+  double FractionBelow(const Value &value) const;
+};
+
+/**
+ * Gathers IndexStatistics in a single pass, fed one page and one key at a time, so that an index can walk its pages
+ * with only the current one latched and leave writers to go on around it. Distinct keys are counted with a
+ * HyperLogLog sketch, and the histogram is cut from a uniform reservoir sample of the first key column, which takes
+ * constant memory however large the index is.
+ */
+class IndexStatisticsCollector {
+ public:
+  /**
+   * @param num_buckets buckets of the histogram
+   * @param sample_size entries sampled for the histogram
+   */
+  explicit IndexStatisticsCollector(size_t num_buckets = 32, size_t sample_size = 1024);
+
+  void SetHeight(uint32_t height) { statistics_.height_ = height; }
+
+  // a page that has used of its capacity slots in use
+  void AddPage(size_t used, size_t capacity);
+
+  /**
+   * Add a key with count values.
+   * @param hash hash of the key, for counting distinct keys
+   * @param first_column the first column of the key, or nullptr if keys cannot be decoded
+   */
+  void AddKey(uint64_t hash, const Value *first_column, uint64_t count = 1);
+
+  IndexStatistics Finish();
+
+ private:
+  IndexStatistics statistics_;
+  size_t num_buckets_;
+  size_t sample_size_;
+  HyperLogLog distinct_keys_;
+  std::vector<Value> sample_;
+  // the smallest and the largest first column, once there is one
+  std::vector<Value> extremes_;
+  double used_slots_{0};
+  std::mt19937_64 rng_;
+};
+
+}  // namespace bustub
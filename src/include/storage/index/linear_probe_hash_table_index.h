@@ -38,6 +38,9 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  // the histogram needs GenericKey keys, which can be decoded
+  IndexStatistics CollectStatistics(Transaction *transaction) override;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
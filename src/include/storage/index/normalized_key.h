@@ -0,0 +1,265 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "common/macros.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** Order-preserving encodings of column values, shared by NormalizedKey and VarLengthKey. */
+class KeyEncoding {
+ public:
+  static inline uint64_t EncodeInteger(int64_t value) { return static_cast<uint64_t>(value) ^ (1ULL << 63); }
+
+  static inline uint64_t EncodeDecimal(double value) {
+    // -0.0 and 0.0 are equal, so they have to encode the same
+    if (value == 0) {
+      value = 0;
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & (1ULL << 63)) != 0 ? ~bits : bits ^ (1ULL << 63);
+  }
+};
+
+/**
+ * NormalizedKey holds an index key in an encoding whose byte order is the key order, so that two keys compare with a
+ * single memcmp instead of deserializing and comparing one Value per column.
+ *
+ * Columns are encoded one after another:
+ *  - integers (and booleans) big-endian with the sign bit flipped, timestamps big-endian
+ *  - decimals as their IEEE 754 bits, with the sign bit flipped for positive numbers and all bits flipped for
+ *    negative ones
+ *  - varchars as their bytes padded with zeros to the declared column length, followed by the actual length as two
+ *    big-endian bytes; a length prefix would order by length first, so it goes behind the padded bytes instead
+ * BusTub represents NULL as the smallest value of each type, which the encoding keeps the smallest.
+ *
+ * The encoding is zero-padded to KeySize and has to fit into it, e.g. a single BIGINT needs 8 bytes.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      const Column &column = key_schema.GetColumn(i);
+      Value value = tuple.GetValue(&key_schema, i);
+      switch (column.GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          offset = Put<uint8_t>(offset, static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U);
+          break;
+        case TypeId::SMALLINT:
+          offset = Put<uint16_t>(offset, static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U);
+          break;
+        case TypeId::INTEGER:
+          offset = Put<uint32_t>(offset, static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U);
+          break;
+        case TypeId::BIGINT:
+          offset = Put<uint64_t>(offset, KeyEncoding::EncodeInteger(value.GetAs<int64_t>()));
+          break;
+        case TypeId::TIMESTAMP:
+          offset = Put<uint64_t>(offset, value.GetAs<uint64_t>());
+          break;
+        case TypeId::DECIMAL:
+          offset = Put<uint64_t>(offset, KeyEncoding::EncodeDecimal(value.GetAs<double>()));
+          break;
+        case TypeId::VARCHAR: {
+          // the serialized length counts the terminating null character
+          uint32_t length = value.IsNull() ? 0 : value.GetLength();
+          if (length > 0 && value.GetData()[length - 1] == '\0') {
+            length--;
+          }
+          size_t width = std::max(column.GetVariableLength(), length);
+          BUSTUB_ASSERT(offset + width + 2 <= KeySize, "Normalized key does not fit");
+          memcpy(data_ + offset, value.GetData(), length);
+          offset = Put<uint16_t>(offset + width, static_cast<uint16_t>(length));
+          break;
+        }
+        default:
+          BUSTUB_ASSERT(false, "Cannot normalize this type");
+      }
+    }
+  }
+
+  // NOTE: for test purpose only
+  // encode as a BIGINT key, or as an INTEGER key if the key is too small
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    if constexpr (KeySize < sizeof(uint64_t)) {
+      Put<uint32_t>(0, static_cast<uint32_t>(key) ^ 0x80000000U);
+    } else {
+      Put<uint64_t>(0, KeyEncoding::EncodeInteger(key));
+    }
+  }
+
+  // NOTE: for test purpose only
+  // decode the key SetFromInteger encoded
+  inline int64_t ToString() const {
+    if constexpr (KeySize < sizeof(uint64_t)) {
+      uint32_t bits;
+      memcpy(&bits, data_, sizeof(bits));
+      return static_cast<int32_t>(__builtin_bswap32(bits) ^ 0x80000000U);
+    } else {
+      uint64_t bits;
+      memcpy(&bits, data_, sizeof(bits));
+      return static_cast<int64_t>(__builtin_bswap64(bits) ^ (1ULL << 63));
+    }
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  char data_[KeySize];
+
+ private:
+  /** Store value big-endian at offset. @return the offset behind it */
+  template <typename T>
+  inline size_t Put(size_t offset, T value) {
+    BUSTUB_ASSERT(offset + sizeof(T) <= KeySize, "Normalized key does not fit");
+    for (size_t i = 0; i < sizeof(T); i++) {
+      data_[offset + i] = static_cast<char>(value >> (8 * (sizeof(T) - 1 - i)));
+    }
+    return offset + sizeof(T);
+  }
+};
+
+/**
+ * Compares normalized keys bytewise. Keys of 4 and 8 bytes, i.e. single INTEGER or BIGINT keys, are compared as one
+ * byte-swapped integer.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    if constexpr (KeySize == sizeof(uint64_t)) {
+      uint64_t l;
+      uint64_t r;
+      memcpy(&l, lhs.data_, sizeof(l));
+      memcpy(&r, rhs.data_, sizeof(r));
+      l = __builtin_bswap64(l);
+      r = __builtin_bswap64(r);
+      return (l > r) - (l < r);
+    }
+    if constexpr (KeySize == sizeof(uint32_t)) {
+      uint32_t l;
+      uint32_t r;
+      memcpy(&l, lhs.data_, sizeof(l));
+      memcpy(&r, rhs.data_, sizeof(r));
+      l = __builtin_bswap32(l);
+      r = __builtin_bswap32(r);
+      return (l > r) - (l < r);
+    }
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+
+  NormalizedComparator() = default;
+
+  // the order is in the keys themselves, the schema is only taken to be interchangeable with GenericComparator
+  explicit NormalizedComparator(Schema *key_schema) {}
+};
+
+/**
+ * VarLengthKey encodes an index key like NormalizedKey, as bytes whose order is the key order, but takes only as many
+ * bytes as the key needs. It is meant for trees with variable-length keys (see VarLengthBPlusTree), whose keys are
+ * then compared with memcmp and shorter keys first on a common prefix.
+ *
+ * Fixed-size columns are encoded as in NormalizedKey. A varchar is not padded: its bytes are followed by the two bytes
+ * 0x00 0x00, and a zero byte within it is escaped as 0x00 0xff. Then a string still sorts before any longer string
+ * that starts with it, and no encoded key is a prefix of a different key of the same schema.
+ */
+class VarLengthKey {
+ public:
+  static inline std::string Encode(const Tuple &tuple, const Schema &key_schema) {
+    std::string key;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      Value value = tuple.GetValue(&key_schema, i);
+      switch (key_schema.GetColumn(i).GetType()) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          Put<uint8_t>(&key, static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U);
+          break;
+        case TypeId::SMALLINT:
+          Put<uint16_t>(&key, static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U);
+          break;
+        case TypeId::INTEGER:
+          Put<uint32_t>(&key, static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U);
+          break;
+        case TypeId::BIGINT:
+          Put<uint64_t>(&key, KeyEncoding::EncodeInteger(value.GetAs<int64_t>()));
+          break;
+        case TypeId::TIMESTAMP:
+          Put<uint64_t>(&key, value.GetAs<uint64_t>());
+          break;
+        case TypeId::DECIMAL:
+          Put<uint64_t>(&key, KeyEncoding::EncodeDecimal(value.GetAs<double>()));
+          break;
+        case TypeId::VARCHAR: {
+          // the serialized length counts the terminating null character
+          uint32_t length = value.IsNull() ? 0 : value.GetLength();
+          if (length > 0 && value.GetData()[length - 1] == '\0') {
+            length--;
+          }
+          for (uint32_t j = 0; j < length; j++) {
+            key.push_back(value.GetData()[j]);
+            if (value.GetData()[j] == '\0') {
+              key.push_back(static_cast<char>(0xff));
+            }
+          }
+          key.append(2, '\0');
+          break;
+        }
+        default:
+          BUSTUB_ASSERT(false, "Cannot normalize this type");
+      }
+    }
+    return key;
+  }
+
+  // NOTE: for test purpose only
+  // encode as a BIGINT key
+  static inline std::string FromInteger(int64_t key) {
+    std::string result;
+    Put<uint64_t>(&result, KeyEncoding::EncodeInteger(key));
+    return result;
+  }
+
+ private:
+  /** Append value big-endian to key. */
+  template <typename T>
+  static inline void Put(std::string *key, T value) {
+    for (size_t i = 0; i < sizeof(T); i++) {
+      key->push_back(static_cast<char>(value >> (8 * (sizeof(T) - 1 - i))));
+    }
+  }
+};
+
+/** True if the comparator orders keys by their bytes, so that keys can be stored and searched without their prefix. */
+template <typename KeyType, typename KeyComparator>
+struct IsByteComparable : std::false_type {};
+
+template <size_t KeySize>
+struct IsByteComparable<NormalizedKey<KeySize>, NormalizedComparator<KeySize>> : std::true_type {};
+
+}  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/var_length_b_plus_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/**
+ * B+ tree whose keys are byte strings of any length up to MaxKeySize, ordered by memcmp and shorter keys first on a
+ * common prefix, such as the keys VarLengthKey encodes. BPlusTree takes keys of a fixed size, padded to the longest
+ * key that may occur; here each key only takes the bytes it has, on slotted pages (see BPlusTreeSlottedPage), and the
+ * keys of internal pages are cut down to the shortest prefix that still separates their children.
+ *
+ * Lookups and removals descend with read latches and latch only the leaf, which they write latch to remove. Insert
+ * tries the same and, if the leaf is out of room, crabs down with write latches instead, keeping the ancestors that
+ * may split and root_latch_ in the transaction's page set; a page is safe once it has room for an entry with the
+ * longest key. Parent page ids are not maintained, a split finds the parent in the page set. Pages are never merged,
+ * so removals do not restructure the tree at all, and a leaf may even become empty.
+ *
+ * With unique unset, every key is stored with the record id appended, eight bytes in big-endian order, which keeps the
+ * pairs of a key next to each other and ordered. Their key is then a prefix of all of them, the values of a key are
+ * read by scanning the leaves from its lower bound on while the prefix matches.
+ */
+class VarLengthBPlusTree {
+  using InternalPage = BPlusTreeSlottedPage<page_id_t>;
+  using LeafPage = BPlusTreeSlottedPage<RID>;
+
+ public:
+  explicit VarLengthBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, bool unique = true);
+
+  // Returns true if this B+ tree has no keys and values.
+  bool IsEmpty() const;
+
+  // Insert a key-value pair into this B+ tree, false if the key (the pair, if keys are not unique) is already there.
+  bool Insert(std::string_view key, const RID &value, Transaction *transaction = nullptr);
+
+  // Remove a key and all of its values from this B+ tree.
+  void Remove(std::string_view key, Transaction *transaction = nullptr);
+
+  // Remove a single key-value pair from this B+ tree.
+  void Remove(std::string_view key, const RID &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key, in increasing order if keys are not unique
+  bool GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction = nullptr);
+
+  // the longest key the tree takes, longer keys throw an OUT_OF_RANGE exception
+  size_t MaxKeySize() const;
+
+ private:
+  /**
+   * Descend to the leaf that may hold key with read latches only.
+   * @return the pinned leaf, write latched if exclusive is set and read latched otherwise, or nullptr if the tree is
+   * empty
+   */
+  Page *FindLeafPage(std::string_view key, bool exclusive);
+
+  /**
+   * Descend to the leaf that may hold key, latch crabbing with write latches. Every page that may still split, and
+   * root_latch_ while the root may, is kept in the transaction's page set (root_latch_ is represented by nullptr).
+   * @return the pinned and write latched leaf, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageForInsert(std::string_view key, Transaction *transaction);
+
+  /**
+   * Move on from the latched leaf to the next one, pinning it before the leaf is released and latching it after.
+   * @return the next leaf, latched like page, or nullptr at the last leaf
+   */
+  Page *MoveToNextLeaf(Page *page, bool exclusive, bool is_dirty = false);
+
+  /** Unlatch and unpin every page in the transaction's page set, and release root_latch_ if it is held. */
+  void ReleaseLatchedPages(Transaction *transaction, bool is_dirty);
+
+  /** @return the key stored for the pair, with the value appended if keys are not unique */
+  std::string MakeKey(std::string_view key, const RID &value) const;
+
+  bool InsertIntoLeaf(std::string_view key, const RID &value, Transaction *transaction);
+
+  /**
+   * Insert the new right sibling of the page at position index of the page set into the parent, which precedes it in
+   * the page set, splitting the parent in turn if it is out of room.
+   */
+  void InsertIntoParent(Transaction *transaction, size_t index, const std::string &key, page_id_t new_page_id);
+
+  /** Allocate a page for a new node, @return the pinned page */
+  Page *NewPage(page_id_t *page_id);
+
+  void RemoveEntry(std::string_view key, const RID *value);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  bool unique_;
+  ReaderWriterLatch root_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/var_length_b_plus_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/var_length_b_plus_tree.h"
+
+namespace bustub {
+
+/**
+ * B+ tree index on keys of any length, such as keys with long varchar columns. The key tuples are encoded with
+ * VarLengthKey, so that each key only takes the bytes it needs instead of a fixed size.
+ */
+class VarLengthBPlusTreeIndex : public Index {
+ public:
+  VarLengthBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+ protected:
+  // container
+  VarLengthBPlusTree container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_epsilon_tree_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_EPSILON_TREE_LEAF_PAGE_TYPE BEpsilonTreeLeafPage<KeyType, ValueType, KeyComparator>
+#define B_EPSILON_TREE_INTERNAL_PAGE_TYPE BEpsilonTreeInternalPage<KeyType, ValueType, KeyComparator>
+#define B_EPSILON_TREE_INTERNAL_PAGE_HEADER_SIZE 32
+
+/** What a message does to its key, see BEpsilonTree. */
+enum class BEpsilonMessageType : int32_t {
+  // give the key a value, unless it already has one
+  INSERT = 0,
+  // give the key a value, replacing the one it has
+  UPSERT,
+  // remove the key
+  DELETE
+};
+
+/** A pending change to a key, buffered in an internal page of a BEpsilonTree. */
+template <typename KeyType, typename ValueType>
+struct BEpsilonMessage {
+  KeyType key_;
+  ValueType value_;
+  BEpsilonMessageType type_;
+};
+
+/**
+ * Leaf page of a BEpsilonTree, the pairs of its keys in increasing key order. Leaves are not linked, and they are
+ * read and written as a whole as messages are applied to them.
+ *
+ * Leaf page format:
+ *  ----------------------------------------------------------
+ * | HEADER | KEY(1)+VALUE(1) | KEY(2)+VALUE(2) | ... | KEY(n)+VALUE(n) |
+ *  ----------------------------------------------------------
+ *
+ * The header is the common B+ tree page header.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTreeLeafPage : public BPlusTreePage {
+ public:
+  void Init(page_id_t page_id, int max_size);
+
+  // the most pairs that fit on a page
+  static int Capacity();
+
+  // append the pairs of this page to pairs
+  void Load(std::vector<MappingType> *pairs) const;
+
+  // replace the pairs of this page with size pairs, at most MaxSize
+  void Store(const MappingType *pairs, int size);
+
+  bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
+
+ private:
+  MappingType array_[0];
+};
+
+/**
+ * Internal page of a BEpsilonTree. Besides the n child pointers and their n-1 pivot keys, laid out as in
+ * BPlusTreeInternalPage with an invalid first key, it holds a buffer of the messages that have not been passed on to
+ * the children yet. The messages are ordered by key, and the messages of a key by their arrival.
+ *
+ * Internal page format:
+ *  -----------------------------------------------------------------------------------------
+ * | HEADER | PAGE_ID(1) ... PAGE_ID(MaxSize) | KEY(1) ... KEY(MaxSize) | MESSAGE(1) ... MESSAGE(m) |
+ *  -----------------------------------------------------------------------------------------
+ *
+ * The header extends the common B+ tree page header with BufferSize (4), the number of messages, and four bytes of
+ * padding. The space of MaxSize children is reserved, the rest of the page is taken by the buffer.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BEpsilonTreeInternalPage : public BPlusTreePage {
+  using Message = BEpsilonMessage<KeyType, ValueType>;
+
+ public:
+  void Init(page_id_t page_id, int max_size);
+
+  // the most messages that fit next to max_size children
+  static int BufferCapacity(int max_size);
+  int BufferCapacity() const;
+  int GetBufferSize() const;
+
+  page_id_t ChildAt(int index) const;
+
+  // the index of the child whose subtree holds key
+  int ChildIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  // append the pivots (the first one invalid), children and buffered messages of this page to the vectors
+  void Load(std::vector<KeyType> *pivots, std::vector<page_id_t> *children, std::vector<Message> *messages) const;
+
+  /**
+   * Replace the contents of this page with size children, at most MaxSize, and num_messages messages, at most
+   * BufferCapacity. pivots[0] is not stored.
+   */
+  void Store(const KeyType *pivots, const page_id_t *children, int size, const Message *messages, int num_messages);
+
+  // buffer a new message after the messages of its key, if there is room for it
+  bool InsertMessage(const Message &message, const KeyComparator &comparator);
+
+  // append the buffered messages of key to messages, oldest first
+  void FindMessages(const KeyType &key, const KeyComparator &comparator, std::vector<Message> *messages) const;
+
+ private:
+  page_id_t *Children();
+  const page_id_t *Children() const;
+  KeyType *Pivots();
+  const KeyType *Pivots() const;
+  Message *Messages();
+  const Message *Messages() const;
+  // the first buffered message whose key is greater than key
+  int UpperBound(const KeyType &key, const KeyComparator &comparator) const;
+
+  int buffer_size_;
+  int padding_ __attribute__((__unused__));
+  char data_[0];
+};
+
+}  // namespace bustub
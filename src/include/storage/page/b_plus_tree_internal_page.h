@@ -13,12 +13,13 @@
 #include <queue>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/key_prefix.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 36
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,12 +32,28 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The header extends the common B+ tree page header with NextPageId (4), the right sibling on the same level,
+ * PrefixSize (4), SizeLimit (4), and the fences LowKey and HighKey (one key each), the bounds of the keys below this
+ * page. The invalid first key stands for LowKey. Like on leaves, HighKey is meaningless while NextPageId is invalid,
+ * and a page initialized to compress keys stores them without the prefix of its fences. Since an internal page holds
+ * one extra pair before it splits, its MaxSize is then one less than the pairs that fit.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool compress = false);
+
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  KeyType GetLowKey() const;
+  KeyType GetHighKey() const;
+  void SetFences(const KeyType &low_key, const KeyType &high_key);
+  int MaxSizeFor(const KeyType &low_key, const KeyType &high_key) const;
+  int GetPrefixSize() const;
+  static int Capacity(int prefix_size);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
@@ -44,8 +61,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  ValueType LookupBefore(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  void Append(const KeyType &key, const ValueType &value, BufferPoolManager *buffer_pool_manager);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
@@ -58,9 +77,20 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  using Prefix = KeyPrefix<KeyType, ValueType>;
+
+  char *EntryAt(int index);
+  const char *EntryAt(int index) const;
+  void SetItem(int index, const MappingType &pair);
+  void CopyNFrom(const BPlusTreeInternalPage *donor, int start, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  void Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager);
+  page_id_t next_page_id_;
+  int prefix_size_;
+  int size_limit_;
+  KeyType low_key_;
+  KeyType high_key_;
   MappingType array[0];
 };
 }  // namespace bustub
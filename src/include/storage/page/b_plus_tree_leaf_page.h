@@ -14,60 +14,94 @@
 #include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/key_prefix.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 36
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. A key appears once, unless the tree has non-unique keys: then the pairs of
+ * a key follow each other ordered by value, or a single pair refers to the
+ * posting list of a key with many values (see BPlusTreePostingPage).
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes plus two keys in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrefixSize (4) | SizeLimit (4) | LowKey | HighKey |
+ *  ---------------------------------------------------------------------------------------------------
+ *
+ * NextPageId links the leaves from left to right. LowKey and HighKey are the fences of the page: all of its keys K
+ * satisfy LowKey <= K < HighKey, where HighKey is the first key of the next page. The first leaf has the smallest
+ * key bytes as LowKey, and the HighKey of the rightmost leaf, whose NextPageId is invalid, is meaningless.
+ *
+ * A page initialized to compress keys stores them without the PrefixSize bytes the fences have in common (see
+ * KeyPrefix), and fits as many of the shorter pairs as it can, up to SizeLimit. Its MaxSize then changes along with
+ * its fences. Only keys that compare bytewise can be compressed. Without compression PrefixSize is always zero and
+ * SizeLimit is unused.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool compress = false);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  KeyType GetLowKey() const;
+  KeyType GetHighKey() const;
+  void SetFences(const KeyType &low_key, const KeyType &high_key);
+  int MaxSizeFor(const KeyType &low_key, const KeyType &high_key) const;
+  int GetPrefixSize() const;
   KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+
+  // the number of pairs fitting on a page whose keys are stored without prefix_size bytes
+  static int Capacity(int prefix_size);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+  void SetValueAt(int index, const ValueType &value);
 
   // Split and Merge utility methods
-  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyComparator &comparator);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
+  using Prefix = KeyPrefix<KeyType, ValueType>;
+
+  char *EntryAt(int index);
+  const char *EntryAt(int index) const;
+  void SetItem(int index, const MappingType &item);
+  void CopyNFrom(const BPlusTreeLeafPage *donor, int start, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
+  int prefix_size_;
+  int size_limit_;
+  KeyType low_key_;
+  KeyType high_key_;
   MappingType array[0];
 };
 }  // namespace bustub
@@ -16,7 +16,9 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "storage/index/covering_value.h"
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 
 namespace bustub {
 
@@ -64,12 +66,12 @@ class BPlusTreePage {
 
  private:
   // member variable, attributes that both internal and leaf page share
-  IndexPageType page_type_ __attribute__((__unused__));
+  IndexPageType page_type_;
   lsn_t lsn_ __attribute__((__unused__));
-  int size_ __attribute__((__unused__));
-  int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
-  page_id_t page_id_ __attribute__((__unused__));
+  int size_;
+  int max_size_;
+  page_id_t parent_page_id_;
+  page_id_t page_id_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 8
+#define POSTING_PAGE_SIZE static_cast<int>((PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / sizeof(RID))
+
+/**
+ * Overflow page of a posting list, the record ids of a key that has too many of them to keep in its leaf.
+ *
+ * In a B+ tree with non-unique keys, a key with many record ids has a single pair in its leaf, whose value refers to
+ * the first page of its posting list instead of a tuple (see MakeReference). The pages of a posting list are linked
+ * from left to right, and together hold the record ids in increasing order. The pages are only ever reached through
+ * the pair in the leaf, so the latch on the leaf protects them as well.
+ *
+ * Posting page format (record ids are stored in order):
+ *  ---------------------------------------------------------------------
+ * | NextPageId (4) | CurrentSize (4) | RID(1) | RID(2) | ... | RID(n) |
+ *  ---------------------------------------------------------------------
+ */
+class BPlusTreePostingPage {
+ public:
+  // After creating a new posting page from buffer pool, must call initialize method to set default values
+  void Init();
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  int GetSize() const;
+  bool IsFull() const;
+  RID ValueAt(int index) const;
+  bool Contains(const RID &value) const;
+
+  // insert and delete methods, both return false if there was nothing to do
+  bool Insert(const RID &value);
+  bool Remove(const RID &value);
+
+  // append a value larger than all others, used to fill new pages
+  void Append(const RID &value);
+  // move the upper half of the values to the empty page that follows this one
+  void MoveHalfTo(BPlusTreePostingPage *recipient);
+
+  /** @return the value a leaf stores for the posting list starting at page_id */
+  static RID MakeReference(page_id_t page_id);
+  /** @return true if the value of a leaf pair refers to a posting list, whose first page is then put in *page_id */
+  static bool IsReference(const RID &value, page_id_t *page_id);
+  /** @return true if lhs comes before rhs in a posting list */
+  static bool Less(const RID &lhs, const RID &rhs);
+
+ private:
+  // no tuple ever has this slot, it marks a reference to a posting list
+  static constexpr uint32_t REFERENCE_SLOT = UINT32_MAX;
+
+  /** @return the first index whose value is not less than value */
+  int ValueIndex(const RID &value) const;
+
+  page_id_t next_page_id_;
+  int size_;
+  RID array_[0];
+};
+
+}  // namespace bustub
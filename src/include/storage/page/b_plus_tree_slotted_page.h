@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_slotted_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define SLOTTED_PAGE_HEADER_SIZE 36
+
+/**
+ * Page of a B+ tree with variable-length keys (see VarLengthBPlusTree), a leaf if ValueType is RID and an internal
+ * page if it is page_id_t. Keys are byte strings that compare with memcmp, shorter keys first on a common prefix.
+ *
+ * Slotted page format:
+ *  ---------------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | free space | ... | ENTRY(2) | ENTRY(1) |
+ *  ---------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 36 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  ------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | FreeOffset (4) | Garbage (4) |
+ *  ------------------------------------------------------------------------------
+ *
+ * The slots are kept in key order, each holds the offset and the key size of its entry, the key bytes directly
+ * followed by the value. Entries are allocated from the end of the page down to FreeOffset, in no particular order.
+ * Removing an entry only drops its slot, its bytes count as Garbage until the page is compacted, which happens when
+ * an insertion does not fit into the free space otherwise. MaxSize and ParentPageId are unused.
+ *
+ * As on a fixed-size internal page, the key of the first entry of an internal page is invalid; it is stored empty.
+ */
+template <typename ValueType>
+class BPlusTreeSlottedPage : public BPlusTreePage {
+  static_assert(PAGE_SIZE <= 65536, "slots hold 16 bit offsets");
+
+ public:
+  // After creating a new page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+
+  std::string_view KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+  int ValueIndex(const ValueType &value) const;
+
+  /** @return the first index whose key is not less than key, or the size of the page */
+  int KeyIndex(std::string_view key) const;
+  /** @return the child of an internal page whose range holds key */
+  ValueType Lookup(std::string_view key) const;
+
+  /** @return true if an entry with a key of key_size bytes fits, possibly after compaction */
+  bool HasRoom(size_t key_size) const;
+  void InsertAt(int index, std::string_view key, const ValueType &value);
+  void RemoveAt(int index);
+
+  /**
+   * Move the entries from the middle on to the empty page that follows this one, splitting the bytes they take about
+   * evenly. Leaves keep the key of every entry, while the first key moved to an internal page becomes invalid.
+   * @return the separator of the two pages for their parent; for leaves, the shortest prefix of the first moved key
+   * that is greater than the last key that stays, since any such key routes lookups correctly
+   */
+  std::string MoveHalfTo(BPlusTreeSlottedPage *recipient);
+
+  /** @return the largest key that fits, four entries of it fill a page */
+  static constexpr size_t MaxKeySize() {
+    return (PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE) / 4 - sizeof(Slot) - sizeof(ValueType);
+  }
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t key_size_;
+  };
+
+  /** @return the bytes not taken by the header, slots or entries, garbage included */
+  size_t FreeSpace() const;
+  /** Move the entries together at the end of the page, dropping the garbage between them. */
+  void Compact();
+
+  const char *EntryAt(int index) const { return reinterpret_cast<const char *>(this) + slots_[index].offset_; }
+  char *EntryAt(int index) { return reinterpret_cast<char *>(this) + slots_[index].offset_; }
+
+  page_id_t next_page_id_;
+  uint32_t free_offset_;
+  uint32_t garbage_;
+  Slot slots_[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Bucket page of an extendible hash table, which stores the pairs of the keys whose hashes end in the same local
+ * depth bits. Supports non-unique keys, but not a pair twice. Like a block page, each slot has an occupied flag, set
+ * once the slot was used, and a readable flag, set while it holds a pair. A pair goes to the first slot that is not
+ * readable, so that the occupied slots stay in front and lookups stop at the first free one.
+ *
+ * The caller latches the page; unlike a block page, which is shared between the probes of concurrent writers, the
+ * flags are plain bytes.
+ *
+ * A bucket whose keys all have the same hash cannot be split, it grows a chain of overflow buckets instead, each
+ * linked from the one before by its page id. The overflow buckets are latched through the first bucket of the chain.
+ *
+ * Bucket page format (keys are stored in no particular order):
+ *  ----------------------------------------------------------------------------------------------
+ * | NextPageId (4) | Occupied flags | Readable flags | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------------------------------
+ *
+ *  Here '+' means concatenation.
+ *
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /** Clear the flags of a new page, which has no overflow bucket. */
+  void Init();
+
+  /** @return the page id of the overflow bucket, INVALID_PAGE_ID if there is none */
+  page_id_t GetNextPageId() const;
+
+  void SetNextPageId(page_id_t next_page_id);
+
+  /**
+   * Append the values of a key to result.
+   * @return whether the key has any value
+   */
+  bool GetValue(const KeyType &key, const KeyComparator &comparator, std::vector<ValueType> *result) const;
+
+  /** @return whether the bucket holds the pair */
+  bool Contains(const KeyType &key, const ValueType &value, const KeyComparator &comparator) const;
+
+  /**
+   * Insert a pair into the first slot that is not readable.
+   * @return false if the bucket holds the pair already, or is full
+   */
+  bool Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+
+  /**
+   * Remove a pair.
+   * @return false if the bucket does not hold it
+   */
+  bool Remove(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+
+  KeyType KeyAt(slot_offset_t bucket_idx) const;
+
+  ValueType ValueAt(slot_offset_t bucket_idx) const;
+
+  /** Remove the pair in a slot, which stays occupied. */
+  void RemoveAt(slot_offset_t bucket_idx);
+
+  bool IsOccupied(slot_offset_t bucket_idx) const;
+
+  bool IsReadable(slot_offset_t bucket_idx) const;
+
+  /** @return the number of pairs */
+  uint32_t NumReadable() const;
+
+  bool IsFull() const;
+
+  bool IsEmpty() const;
+
+ private:
+  void SetOccupied(slot_offset_t bucket_idx);
+  void SetReadable(slot_offset_t bucket_idx, bool readable);
+
+  page_id_t next_page_id_;
+  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // 0 if tombstone/brand new (never occupied), 1 otherwise.
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
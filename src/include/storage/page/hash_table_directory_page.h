@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * The directory has 2^GlobalDepth entries, entry i holds the bucket of the keys whose hash ends in the bits of i. A
+ * bucket with LocalDepth d is shared by the 2^(GlobalDepth - d) entries that end in the same d bits, each of which
+ * records d.
+ *
+ * Directory format (size in byte):
+ * --------------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth (4) | LocalDepths (512) | BucketPageIds (2048) | Free (1524) |
+ * --------------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableDirectoryPage() = delete;
+
+  /**
+   * Initialize a directory of a single entry, which holds the first bucket.
+   * @param page_id the page id of this page
+   * @param bucket_page_id the page id of the first bucket
+   */
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const;
+  void SetPageId(page_id_t page_id);
+
+  lsn_t GetLSN() const;
+  void SetLSN(lsn_t lsn);
+
+  /** @return the number of entries, 2^GlobalDepth */
+  uint32_t Size() const;
+
+  uint32_t GetGlobalDepth() const;
+
+  /** @return the low GlobalDepth bits set, the mask of the hash bits that pick an entry */
+  uint32_t GetGlobalDepthMask() const;
+
+  /** Double the directory, the entries of the new half share the buckets of their counterparts in the old one. */
+  void IncrGlobalDepth();
+
+  /** Halve the directory, see CanShrink. */
+  void DecrGlobalDepth();
+
+  /** @return whether every bucket has a smaller local depth than the global one, so that the upper half repeats */
+  bool CanShrink() const;
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /** @return the low LocalDepth bits set, the mask of the hash bits all keys of the bucket share */
+  uint32_t GetLocalDepthMask(uint32_t bucket_idx) const;
+
+  /**
+   * @return the entry of the bucket that this one was split from or into, which differs in the highest of the
+   * LocalDepth bits; the bucket must have a local depth of at least one
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  /**
+   * Assert that no local depth exceeds the global one, that the entries sharing a bucket agree on its local depth,
+   * and that a bucket of local depth d is shared by exactly 2^(GlobalDepth - d) entries.
+   */
+  void VerifyIntegrity() const;
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+}  // namespace bustub
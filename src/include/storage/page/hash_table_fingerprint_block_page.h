@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_fingerprint_block_page.h
+//
+// Identification: src/include/storage/page/hash_table_fingerprint_block_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Block page of a linear probing hash table with a control byte per slot, after the Swiss tables of Abseil, in place
+ * of the occupied and readable bits of HashTableBlockPage. A control byte is 0 for a slot that was never occupied,
+ * marks a tombstone or a slot claimed by an insert that is still writing its pair, or else has the high bit set over
+ * the top 7 bits of the hash of the key in the slot, its fingerprint. A probe matches the fingerprint of its key
+ * against a group of 16 (SSE2) or 32 (AVX2) control bytes at once and only compares the keys of the slots that match,
+ * on average 1 in 128 of those that hold other keys.
+ *
+ * Block page format:
+ *  -----------------------------------------------------------------------------------
+ * | CONTROL(1) | ... | CONTROL(n) | PADDING | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  -----------------------------------------------------------------------------------
+ *
+ * The padding reads as never occupied, a group that runs past the last slot is cut short.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableFingerprintBlockPage {
+ public:
+  // control bytes matched at once
+#ifdef __AVX2__
+  static constexpr size_t GROUP_SIZE = 32;
+#else
+  static constexpr size_t GROUP_SIZE = 16;
+#endif
+
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableFingerprintBlockPage() = delete;
+
+  /** @return the fingerprint of a key with the given hash, the top 7 bits of the hash with the high bit set */
+  static uint8_t Fingerprint(uint64_t hash) { return static_cast<uint8_t>(0x80 | hash >> 57); }
+
+  KeyType KeyAt(slot_offset_t bucket_ind) const;
+
+  ValueType ValueAt(slot_offset_t bucket_ind) const;
+
+  /**
+   * Attempts to insert a key and value into an index in the block, thread safe as HashTableBlockPage::Insert: the index
+   * is claimed with a compare and swap of its control byte, which gets the fingerprint once the pair is written.
+   *
+   * @param bucket_ind index to write the key and value to
+   * @param fingerprint fingerprint of the key
+   * @return false if the index was occupied already
+   */
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
+
+  /** Leave a tombstone at an index. */
+  void Remove(slot_offset_t bucket_ind);
+
+  // whether an index holds a pair, a tombstone or a claim
+  bool IsOccupied(slot_offset_t bucket_ind) const;
+
+  // whether an index holds a pair
+  bool IsReadable(slot_offset_t bucket_ind) const;
+
+  /**
+   * Match the control bytes of the group of GROUP_SIZE indexes from bucket_ind, bit i of a mask standing for index
+   * bucket_ind + i. Bits past the last index of the block are clear. Control bytes are loaded without synchronizing
+   * with concurrent inserts, IsReadable tells whether the pair of a matching index can be read.
+   *
+   * @param fingerprint fingerprint to look for
+   * @param[out] empty the indexes that were never occupied
+   * @return the indexes whose control byte is fingerprint
+   */
+  uint32_t MatchGroup(slot_offset_t bucket_ind, uint8_t fingerprint, uint32_t *empty) const;
+
+ private:
+  static constexpr uint8_t EMPTY = 0;
+  static constexpr uint8_t TOMBSTONE = 1;
+  static constexpr uint8_t CLAIMED = 2;
+
+  std::atomic<uint8_t> control_[FINGERPRINT_CONTROL_SIZE];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
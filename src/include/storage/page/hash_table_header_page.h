@@ -18,6 +18,7 @@
 #include <string>
 
 #include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
 #include "storage/page/hash_table_page_defs.h"
 
 namespace bustub {
@@ -26,10 +27,10 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 32 bytes in total with padding), followed by the page ids of the blocks:
+ * ------------------------------------------------------------------------
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8) | BlockPageIds ...
+ * ------------------------------------------------------------------------
  */
 class HashTableHeaderPage {
  public:
@@ -89,12 +90,21 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * @return the number of block page_ids that fit the header page
+   */
+  static constexpr size_t MaxNumBlocks();
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  page_id_t block_page_ids_[0];
 };
 
+constexpr size_t HashTableHeaderPage::MaxNumBlocks() {
+  return (PAGE_SIZE - sizeof(HashTableHeaderPage)) / sizeof(page_id_t);
+}
+
 }  // namespace bustub
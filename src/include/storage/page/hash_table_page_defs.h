@@ -22,3 +22,22 @@
 #define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs that fit a bucket page of an extendible hash table, which
+ * keeps the same two flags per pair as a block page after the page id of its overflow bucket. */
+#define BUCKET_ARRAY_SIZE (4 * (PAGE_SIZE - sizeof(page_id_t)) / (4 * sizeof(MappingType) + 1))
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+/** DIRECTORY_ARRAY_SIZE is the number of bucket page ids a directory page holds, 2^DIRECTORY_MAX_DEPTH. */
+#define DIRECTORY_MAX_DEPTH 9
+#define DIRECTORY_ARRAY_SIZE (1U << DIRECTORY_MAX_DEPTH)
+
+/** FINGERPRINT_BLOCK_ARRAY_SIZE is the number of (key, value) pairs that fit a block page with a control byte per
+ * pair, see HashTableFingerprintBlockPage. The control bytes are followed by FINGERPRINT_GROUP_SIZE bytes of padding,
+ * so that a whole group of them can be loaded from any slot, and then rounded up to 8 bytes to align the pairs. */
+#define FINGERPRINT_GROUP_SIZE 32
+#define FINGERPRINT_BLOCK_ARRAY_SIZE ((PAGE_SIZE - FINGERPRINT_GROUP_SIZE - 8) / (sizeof(MappingType) + 1))
+#define FINGERPRINT_CONTROL_SIZE ((FINGERPRINT_BLOCK_ARRAY_SIZE + FINGERPRINT_GROUP_SIZE + 7) / 8 * 8)
+
+#define HASH_TABLE_FINGERPRINT_BLOCK_TYPE HashTableFingerprintBlockPage<KeyType, ValueType, KeyComparator>
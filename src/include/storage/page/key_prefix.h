@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_prefix.h
+//
+// Identification: src/include/storage/page/key_prefix.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <utility>
+
+namespace bustub {
+
+/**
+ * Prefix truncation of the key & value pairs of B+ tree pages.
+ *
+ * Every key on a page lies between the page's low key and high key, its fences. If keys compare bytewise, all of them
+ * start with the bytes the two fences have in common, and a compressing page stores that prefix only once, as the
+ * start of its low key. Each pair is stored as the rest of its key directly followed by its value. With an empty
+ * prefix this is exactly the layout of an array of std::pair<KeyType, ValueType>.
+ */
+template <typename KeyType, typename ValueType>
+class KeyPrefix {
+  static_assert(sizeof(std::pair<KeyType, ValueType>) == sizeof(KeyType) + sizeof(ValueType),
+                "an uncompressed pair has to have the layout of std::pair");
+
+ public:
+  /** @return the bytes a pair takes when its key is stored without the first prefix_size bytes */
+  static constexpr int Stride(int prefix_size) { return sizeof(KeyType) - prefix_size + sizeof(ValueType); }
+
+  /** @return the number of leading bytes low_key and high_key have in common */
+  static int CommonPrefix(const KeyType &low_key, const KeyType &high_key) {
+    auto *low = reinterpret_cast<const char *>(&low_key);
+    auto *high = reinterpret_cast<const char *>(&high_key);
+    int prefix_size = 0;
+    while (prefix_size < static_cast<int>(sizeof(KeyType)) && low[prefix_size] == high[prefix_size]) {
+      prefix_size++;
+    }
+    return prefix_size;
+  }
+
+  /** Set the fences of a page that spans all keys, i.e. the smallest and the largest key bytes. */
+  static void SetUnbounded(KeyType *low_key, KeyType *high_key) {
+    memset(reinterpret_cast<char *>(low_key), 0, sizeof(KeyType));
+    memset(reinterpret_cast<char *>(high_key), 0xff, sizeof(KeyType));
+  }
+
+  /** @return the key of the pair at entry, completed with the prefix of low_key */
+  static KeyType GetKey(const char *entry, const KeyType &low_key, int prefix_size) {
+    KeyType key;
+    memcpy(reinterpret_cast<char *>(&key), &low_key, prefix_size);
+    memcpy(reinterpret_cast<char *>(&key) + prefix_size, entry, sizeof(KeyType) - prefix_size);
+    return key;
+  }
+
+  static ValueType GetValue(const char *entry, int prefix_size) {
+    ValueType value;
+    memcpy(reinterpret_cast<char *>(&value), entry + sizeof(KeyType) - prefix_size, sizeof(ValueType));
+    return value;
+  }
+
+  /** Store the key of the pair at entry; the key has to start with the prefix. */
+  static void SetKey(char *entry, const KeyType &key, int prefix_size) {
+    memcpy(entry, reinterpret_cast<const char *>(&key) + prefix_size, sizeof(KeyType) - prefix_size);
+  }
+
+  static void SetValue(char *entry, const ValueType &value, int prefix_size) {
+    memcpy(entry + sizeof(KeyType) - prefix_size, &value, sizeof(ValueType));
+  }
+
+  /**
+   * Binary search over the pairs from entries[low] to entries[high - 1], comparing keys bytewise.
+   * @return the first index whose key is not less than key (greater than key if upper is set), or high
+   */
+  template <bool upper>
+  static int Search(const char *entries, int low, int high, const KeyType &key, const KeyType &low_key,
+                    int prefix_size) {
+    // a key outside of the page's prefix comes before or after all of its pairs
+    int order = memcmp(&key, &low_key, prefix_size);
+    if (order != 0) {
+      return order < 0 ? low : high;
+    }
+    int stride = Stride(prefix_size);
+    auto *suffix = reinterpret_cast<const char *>(&key) + prefix_size;
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      int cmp = memcmp(entries + mid * stride, suffix, sizeof(KeyType) - prefix_size);
+      if (upper ? cmp <= 0 : cmp < 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+};
+
+}  // namespace bustub
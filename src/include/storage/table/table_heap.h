@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -108,6 +111,18 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the ids of the pages of this table, in the order a scan visits them */
+  std::vector<page_id_t> GetPageIds();
+
+  /**
+   * Read every tuple of one page of this table, under a read latch on the page. Scans of different pages may run in
+   * parallel, each one on a page range of GetPageIds.
+   * @param page_id the page to scan
+   * @param callback called with each tuple of the page, in slot order
+   * @param txn transaction performing the read
+   */
+  void ScanPage(page_id_t page_id, const std::function<void(const Tuple &)> &callback, Transaction *txn);
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -20,6 +21,7 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/page_compressor.h"
 
 namespace bustub {
 
@@ -29,8 +31,17 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool enable_compression)
+    : next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      num_bytes_written_(0),
+      file_name_(db_file),
+      compressed_(enable_compression),
+      slots_end_(0),
+      next_version_(0) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -66,8 +77,23 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
   buffer_used = nullptr;
+
+  if (compressed_) {
+    LoadSlots();
+  }
 }
 
+DiskManager::DiskManager()
+    : next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      num_bytes_written_(0),
+      compressed_(false),
+      slots_end_(0),
+      next_version_(0) {}
+
 /**
  * Close all file streams
  */
@@ -80,11 +106,16 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (compressed_) {
+    WriteCompressedPage(page_id, page_data);
+    return;
+  }
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
   db_io_.write(page_data, PAGE_SIZE);
+  num_bytes_written_ += PAGE_SIZE;
   // check for I/O error
   if (db_io_.bad()) {
     LOG_DEBUG("I/O error while writing");
@@ -98,6 +129,10 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (compressed_) {
+    ReadCompressedPage(page_id, page_data);
+    return;
+  }
   int offset = page_id * PAGE_SIZE;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
@@ -122,6 +157,204 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write a run of consecutive pages with a single seek. Compressed files have no contiguous layout, so the run is
+ * written page by page.
+ */
+void DiskManager::WritePages(page_id_t first_page_id, const char *page_data, int num_pages) {
+  if (compressed_) {
+    for (int i = 0; i < num_pages; i++) {
+      WriteCompressedPage(first_page_id + i, page_data + static_cast<size_t>(i) * PAGE_SIZE);
+    }
+    return;
+  }
+  size_t offset = static_cast<size_t>(first_page_id) * PAGE_SIZE;
+  size_t size = static_cast<size_t>(num_pages) * PAGE_SIZE;
+  num_writes_ += 1;
+  db_io_.seekp(offset);
+  db_io_.write(page_data, size);
+  num_bytes_written_ += size;
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  db_io_.flush();
+}
+
+/**
+ * Read a run of consecutive pages with a single seek. Whatever lies past the end of the file reads as zeros.
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, char *page_data, int num_pages) {
+  if (compressed_) {
+    for (int i = 0; i < num_pages; i++) {
+      ReadCompressedPage(first_page_id + i, page_data + static_cast<size_t>(i) * PAGE_SIZE);
+    }
+    return;
+  }
+  size_t offset = static_cast<size_t>(first_page_id) * PAGE_SIZE;
+  size_t size = static_cast<size_t>(num_pages) * PAGE_SIZE;
+  int file_size = GetFileSize(file_name_);
+  if (file_size < 0 || offset > static_cast<size_t>(file_size)) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, size);
+    return;
+  }
+  db_io_.seekp(offset);
+  db_io_.read(page_data, size);
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  auto read_count = static_cast<size_t>(db_io_.gcount());
+  if (read_count < size) {
+    db_io_.clear();
+    memset(page_data + read_count, 0, size - read_count);
+  }
+}
+
+/**
+ * Compress the page and write it into its slot. The slot is rewritten in place if the new image still fits,
+ * otherwise the page moves to a larger slot and the old one is released.
+ */
+void DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  char buffer[sizeof(SlotHeader) + PAGE_SIZE];
+  char *payload = buffer + sizeof(SlotHeader);
+
+  // only keep the compressed image if it saves at least one slot
+  size_t size = PageCompressor::Compress(page_data, PAGE_SIZE, payload, PAGE_SIZE - SLOT_ALIGNMENT);
+  if (size == 0) {
+    size = PAGE_SIZE;
+    memcpy(payload, page_data, PAGE_SIZE);
+  }
+
+  auto it = page_map_.find(page_id);
+  size_t offset;
+  uint32_t capacity;
+  if (it != page_map_.end() && it->second.capacity_ >= size) {
+    offset = it->second.offset_;
+    capacity = it->second.capacity_;
+  } else {
+    capacity = static_cast<uint32_t>(size);
+    offset = AllocateSlot(&capacity);
+  }
+
+  SlotHeader header{page_id, static_cast<uint32_t>(size), capacity, next_version_++};
+  memcpy(buffer, &header, sizeof(SlotHeader));
+
+  num_writes_ += 1;
+  num_bytes_written_ += sizeof(SlotHeader) + size;
+  db_io_.seekp(offset);
+  db_io_.write(buffer, sizeof(SlotHeader) + size);
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+
+  // the new copy is durable before the old one is released, so a rebuild never loses the page
+  if (it != page_map_.end() && it->second.offset_ != offset) {
+    FreeSlot(it->second.offset_, it->second.capacity_);
+  }
+  page_map_[page_id] = PageSlot{offset, static_cast<uint32_t>(size), capacity};
+  db_io_.flush();
+}
+
+/**
+ * Read the slot of the page and decompress it into the given memory area
+ */
+void DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  auto it = page_map_.find(page_id);
+  if (it == page_map_.end()) {
+    LOG_DEBUG("I/O error reading a page that was never written");
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+
+  const PageSlot &slot = it->second;
+  char buffer[PAGE_SIZE];
+  db_io_.seekp(slot.offset_ + sizeof(SlotHeader));
+  db_io_.read(buffer, slot.size_);
+  if (db_io_.bad() || static_cast<uint32_t>(db_io_.gcount()) != slot.size_) {
+    LOG_DEBUG("I/O error while reading");
+    db_io_.clear();
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+
+  if (slot.size_ == PAGE_SIZE) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  } else if (!PageCompressor::Decompress(buffer, slot.size_, page_data, PAGE_SIZE)) {
+    LOG_DEBUG("corrupted compressed page");
+    memset(page_data, 0, PAGE_SIZE);
+  }
+}
+
+void DiskManager::LoadSlots() {
+  int file_size = GetFileSize(file_name_);
+  size_t offset = 0;
+  std::unordered_map<page_id_t, uint32_t> versions;
+  while (file_size > 0 && offset + sizeof(SlotHeader) <= static_cast<size_t>(file_size)) {
+    SlotHeader header;
+    db_io_.seekp(offset);
+    db_io_.read(reinterpret_cast<char *>(&header), sizeof(SlotHeader));
+    if (db_io_.bad() || header.capacity_ == 0 || header.size_ > header.capacity_) {
+      LOG_DEBUG("stop rebuilding the page map at a corrupted slot");
+      db_io_.clear();
+      break;
+    }
+
+    if (header.page_id_ == INVALID_PAGE_ID) {
+      free_slots_[header.capacity_].push_back(offset);
+    } else {
+      auto it = page_map_.find(header.page_id_);
+      if (it == page_map_.end() || versions[header.page_id_] < header.version_) {
+        if (it != page_map_.end()) {
+          // an older copy left behind by an interrupted relocation
+          free_slots_[it->second.capacity_].push_back(it->second.offset_);
+        }
+        page_map_[header.page_id_] = PageSlot{offset, header.size_, header.capacity_};
+        versions[header.page_id_] = header.version_;
+      } else {
+        free_slots_[header.capacity_].push_back(offset);
+      }
+      next_version_ = std::max(next_version_, header.version_ + 1);
+    }
+    offset += sizeof(SlotHeader) + header.capacity_;
+  }
+  slots_end_ = offset;
+}
+
+size_t DiskManager::AllocateSlot(uint32_t *capacity) {
+  // footprints are rounded up so that freed slots are interchangeable
+  uint32_t footprint = (sizeof(SlotHeader) + *capacity + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+  *capacity = footprint - sizeof(SlotHeader);
+
+  auto it = free_slots_.lower_bound(*capacity);
+  if (it != free_slots_.end()) {
+    size_t offset = it->second.back();
+    *capacity = it->first;
+    it->second.pop_back();
+    if (it->second.empty()) {
+      free_slots_.erase(it);
+    }
+    return offset;
+  }
+
+  size_t offset = slots_end_;
+  slots_end_ += footprint;
+  return offset;
+}
+
+void DiskManager::FreeSlot(size_t offset, uint32_t capacity) {
+  SlotHeader header{INVALID_PAGE_ID, 0, capacity, 0};
+  db_io_.seekp(offset);
+  db_io_.write(reinterpret_cast<const char *>(&header), sizeof(SlotHeader));
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while writing");
+    return;
+  }
+  free_slots_[capacity].push_back(offset);
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -193,9 +426,19 @@ page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
 /**
  * Deallocate page (operations like drop index/table)
  * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Plain files do not need to do anything for now, compressed files give the slot back.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (!compressed_) {
+    return;
+  }
+  auto it = page_map_.find(page_id);
+  if (it != page_map_.end()) {
+    FreeSlot(it->second.offset_, it->second.capacity_);
+    page_map_.erase(it);
+    db_io_.flush();
+  }
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,6 +450,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of page bytes written so far
+ */
+uint64_t DiskManager::GetNumBytesWritten() const { return num_bytes_written_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
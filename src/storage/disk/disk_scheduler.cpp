@@ -0,0 +1,345 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager) : disk_manager_(disk_manager) {
+  worker_ = std::thread(&DiskScheduler::WorkerLoop, this);
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+std::future<void> DiskScheduler::ScheduleRead(page_id_t page_id, char *page_data, IOPriority priority) {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+
+  std::lock_guard<std::mutex> lock(latch_);
+  num_requests_[static_cast<size_t>(priority)]++;
+
+  // the newest image of the page has not reached the disk yet, serve it from the scheduler
+  std::shared_ptr<Request> pending_write;
+  if (auto it = queued_writes_.find(page_id); it != queued_writes_.end()) {
+    pending_write = it->second;
+  } else if (auto it = inflight_writes_.find(page_id); it != inflight_writes_.end()) {
+    pending_write = it->second;
+  }
+  if (pending_write != nullptr) {
+    memcpy(page_data, pending_write->write_buffer_.get(), PAGE_SIZE);
+    promise.set_value();
+    return future;
+  }
+
+  auto request = std::make_shared<Request>();
+  request->type_ = RequestType::READ;
+  request->priority_ = priority;
+  request->page_id_ = page_id;
+  request->data_ = page_data;
+  request->waiters_.push_back(std::move(promise));
+  queues_[static_cast<size_t>(priority)].push_back(std::move(request));
+  cv_.notify_all();
+  return future;
+}
+
+std::future<void> DiskScheduler::ScheduleWrite(page_id_t page_id, const char *page_data, IOPriority priority) {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+
+  std::lock_guard<std::mutex> lock(latch_);
+  num_requests_[static_cast<size_t>(priority)]++;
+
+  auto it = queued_writes_.find(page_id);
+  if (it != queued_writes_.end()) {
+    // absorb the write into the one already queued, and let it jump ahead if this one is more urgent
+    auto request = it->second;
+    memcpy(request->write_buffer_.get(), page_data, PAGE_SIZE);
+    request->waiters_.push_back(std::move(promise));
+    if (priority < request->priority_) {
+      RemoveFromQueue(request);
+      request->priority_ = priority;
+      queues_[static_cast<size_t>(priority)].push_back(request);
+      cv_.notify_all();
+    }
+    return future;
+  }
+
+  auto request = std::make_shared<Request>();
+  request->type_ = RequestType::WRITE;
+  request->priority_ = priority;
+  request->page_id_ = page_id;
+  request->data_ = nullptr;
+  request->write_buffer_ = std::make_unique<char[]>(PAGE_SIZE);
+  memcpy(request->write_buffer_.get(), page_data, PAGE_SIZE);
+  request->waiters_.push_back(std::move(promise));
+  queued_writes_[page_id] = request;
+  queues_[static_cast<size_t>(priority)].push_back(std::move(request));
+  cv_.notify_all();
+  return future;
+}
+
+std::future<void> DiskScheduler::ScheduleLogWrite(char *log_data, int size) {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+
+  auto request = std::make_shared<Request>();
+  request->type_ = RequestType::LOG;
+  request->priority_ = IOPriority::WAL;
+  request->page_id_ = INVALID_PAGE_ID;
+  request->data_ = log_data;
+  request->log_size_ = size;
+  request->waiters_.push_back(std::move(promise));
+
+  std::lock_guard<std::mutex> lock(latch_);
+  num_requests_[static_cast<size_t>(IOPriority::WAL)]++;
+  queues_[static_cast<size_t>(IOPriority::WAL)].push_back(std::move(request));
+  cv_.notify_all();
+  return future;
+}
+
+void DiskScheduler::DeallocatePage(page_id_t page_id) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    auto it = queued_writes_.find(page_id);
+    if (it != queued_writes_.end()) {
+      auto request = it->second;
+      RemoveFromQueue(request);
+      queued_writes_.erase(it);
+      for (auto &waiter : request->waiters_) {
+        waiter.set_value();
+      }
+    }
+    // let a write that is already on its way finish first
+    cv_.wait(lock, [&] { return inflight_writes_.count(page_id) == 0; });
+  }
+
+  std::lock_guard<std::mutex> io_lock(io_latch_);
+  disk_manager_->DeallocatePage(page_id);
+}
+
+void DiskScheduler::SetRateLimit(IOPriority priority, double pages_per_second) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto &limiter = limiters_[static_cast<size_t>(priority)];
+  limiter.pages_per_second_ = pages_per_second;
+  limiter.tokens_ = std::max(1.0, pages_per_second / 10);
+  limiter.last_refill_ = std::chrono::steady_clock::now();
+  cv_.notify_all();
+}
+
+size_t DiskScheduler::GetNumRequests(IOPriority priority) {
+  std::lock_guard<std::mutex> lock(latch_);
+  return num_requests_[static_cast<size_t>(priority)];
+}
+
+size_t DiskScheduler::GetNumDiskIOs() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return num_disk_ios_;
+}
+
+void DiskScheduler::Pause() {
+  std::lock_guard<std::mutex> lock(latch_);
+  paused_ = true;
+}
+
+void DiskScheduler::Resume() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    paused_ = false;
+  }
+  cv_.notify_all();
+}
+
+/*****************************************************************************
+ * WORKER
+ *****************************************************************************/
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    auto now = std::chrono::steady_clock::now();
+    auto retry_at = std::chrono::steady_clock::time_point::max();
+    size_t chosen = NUM_IO_PRIORITIES;
+    bool pending = false;
+
+    // on shutdown everything left is drained, regardless of pauses and rate limits
+    if (!paused_ || shutdown_) {
+      for (size_t priority = 0; priority < NUM_IO_PRIORITIES; priority++) {
+        if (queues_[priority].empty()) {
+          continue;
+        }
+        pending = true;
+        if (shutdown_ || HasTokens(priority, now, &retry_at)) {
+          chosen = priority;
+          break;
+        }
+      }
+    }
+
+    if (chosen == NUM_IO_PRIORITIES) {
+      if (shutdown_ && !pending) {
+        return;
+      }
+      if (retry_at != std::chrono::steady_clock::time_point::max()) {
+        cv_.wait_until(lock, retry_at);
+      } else {
+        cv_.wait(lock);
+      }
+      continue;
+    }
+
+    auto batch = TakeBatch(&queues_[chosen]);
+    auto &limiter = limiters_[chosen];
+    if (limiter.pages_per_second_ > 0) {
+      limiter.tokens_ -= static_cast<double>(batch.size());
+    }
+    for (const auto &request : batch) {
+      if (request->type_ == RequestType::WRITE) {
+        queued_writes_.erase(request->page_id_);
+        inflight_writes_[request->page_id_] = request;
+      }
+    }
+
+    lock.unlock();
+    Dispatch(batch);
+    lock.lock();
+
+    num_disk_ios_++;
+    for (const auto &request : batch) {
+      if (request->type_ == RequestType::WRITE) {
+        inflight_writes_.erase(request->page_id_);
+      }
+      for (auto &waiter : request->waiters_) {
+        waiter.set_value();
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
+bool DiskScheduler::HasTokens(size_t priority, std::chrono::steady_clock::time_point now,
+                              std::chrono::steady_clock::time_point *retry_at) {
+  auto &limiter = limiters_[priority];
+  if (limiter.pages_per_second_ <= 0) {
+    return true;
+  }
+
+  // refill, allowing bursts of up to a tenth of a second worth of pages
+  double burst = std::max(1.0, limiter.pages_per_second_ / 10);
+  double elapsed = std::chrono::duration<double>(now - limiter.last_refill_).count();
+  limiter.tokens_ = std::min(burst, limiter.tokens_ + elapsed * limiter.pages_per_second_);
+  limiter.last_refill_ = now;
+  if (limiter.tokens_ >= 1) {
+    return true;
+  }
+
+  std::chrono::duration<double> wait((1 - limiter.tokens_) / limiter.pages_per_second_);
+  *retry_at = std::min(*retry_at, now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait));
+  return false;
+}
+
+std::vector<std::shared_ptr<DiskScheduler::Request>> DiskScheduler::TakeBatch(
+    std::deque<std::shared_ptr<Request>> *queue) {
+  auto first = queue->front();
+  queue->pop_front();
+  std::vector<std::shared_ptr<Request>> batch{first};
+  if (first->type_ == RequestType::LOG) {
+    return batch;
+  }
+
+  // queued requests of the same kind, by page id
+  std::unordered_map<page_id_t, std::shared_ptr<Request>> candidates;
+  for (const auto &request : *queue) {
+    if (request->type_ == first->type_) {
+      candidates.emplace(request->page_id_, request);
+    }
+  }
+
+  // grow a run of consecutive page ids around the first request
+  page_id_t low = first->page_id_;
+  page_id_t high = first->page_id_;
+  while (static_cast<int>(batch.size()) < MAX_MERGED_PAGES) {
+    auto it = candidates.find(high + 1);
+    if (it == candidates.end()) {
+      it = candidates.find(low - 1);
+      if (it == candidates.end()) {
+        break;
+      }
+      low--;
+    } else {
+      high++;
+    }
+    batch.push_back(it->second);
+  }
+
+  if (batch.size() > 1) {
+    std::unordered_set<Request *> taken;
+    for (const auto &request : batch) {
+      taken.insert(request.get());
+    }
+    auto is_taken = [&](const std::shared_ptr<Request> &request) { return taken.count(request.get()) > 0; };
+    queue->erase(std::remove_if(queue->begin(), queue->end(), is_taken), queue->end());
+    std::sort(batch.begin(), batch.end(), [](const std::shared_ptr<Request> &a, const std::shared_ptr<Request> &b) {
+      return a->page_id_ < b->page_id_;
+    });
+  }
+  return batch;
+}
+
+void DiskScheduler::Dispatch(const std::vector<std::shared_ptr<Request>> &batch) {
+  std::lock_guard<std::mutex> io_lock(io_latch_);
+  const auto &first = batch.front();
+
+  if (first->type_ == RequestType::LOG) {
+    disk_manager_->WriteLog(first->data_, first->log_size_);
+    return;
+  }
+
+  if (batch.size() == 1) {
+    if (first->type_ == RequestType::READ) {
+      disk_manager_->ReadPage(first->page_id_, first->data_);
+    } else {
+      disk_manager_->WritePage(first->page_id_, first->write_buffer_.get());
+    }
+    return;
+  }
+
+  int num_pages = static_cast<int>(batch.size());
+  std::vector<char> buffer(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  if (first->type_ == RequestType::READ) {
+    disk_manager_->ReadPages(first->page_id_, buffer.data(), num_pages);
+    for (int i = 0; i < num_pages; i++) {
+      memcpy(batch[i]->data_, buffer.data() + static_cast<size_t>(i) * PAGE_SIZE, PAGE_SIZE);
+    }
+  } else {
+    for (int i = 0; i < num_pages; i++) {
+      memcpy(buffer.data() + static_cast<size_t>(i) * PAGE_SIZE, batch[i]->write_buffer_.get(), PAGE_SIZE);
+    }
+    disk_manager_->WritePages(first->page_id_, buffer.data(), num_pages);
+  }
+}
+
+void DiskScheduler::RemoveFromQueue(const std::shared_ptr<Request> &request) {
+  auto &queue = queues_[static_cast<size_t>(request->priority_)];
+  queue.erase(std::remove(queue.begin(), queue.end(), request), queue.end());
+}
+
+}  // namespace bustub
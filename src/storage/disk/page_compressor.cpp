@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_compressor.cpp
+//
+// Identification: src/storage/disk/page_compressor.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_compressor.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr int HASH_LOG = 12;
+constexpr size_t HASH_TABLE_SIZE = 1 << HASH_LOG;
+
+inline uint32_t Load32(const char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Hash(uint32_t v) { return (v * 2654435761U) >> (32 - HASH_LOG); }
+
+/**
+ * Append a length continuation (the part beyond the 15 stored in the token nibble).
+ * @return false if the output buffer is exhausted
+ */
+inline bool PutLength(size_t length, char *dst, size_t capacity, size_t *op) {
+  while (length >= 255) {
+    if (*op >= capacity) {
+      return false;
+    }
+    dst[(*op)++] = static_cast<char>(255);
+    length -= 255;
+  }
+  if (*op >= capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(length);
+  return true;
+}
+
+/**
+ * Read a length continuation.
+ * @return false if the input ends in the middle of the length
+ */
+inline bool GetLength(const char *src, size_t src_size, size_t *ip, size_t *length) {
+  uint8_t b;
+  do {
+    if (*ip >= src_size) {
+      return false;
+    }
+    b = static_cast<uint8_t>(src[(*ip)++]);
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+/**
+ * Emit one record: literals src[anchor, anchor + literal_length) followed by an optional match.
+ * @return false if the output buffer is exhausted
+ */
+bool EmitSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, char *dst,
+                  size_t capacity, size_t *op) {
+  size_t match_code = match_length == 0 ? 0 : match_length - PageCompressor::MIN_MATCH;
+  if (*op >= capacity) {
+    return false;
+  }
+  size_t token_pos = (*op)++;
+  uint8_t token = static_cast<uint8_t>((literal_length >= 15 ? 15 : literal_length) << 4);
+  token |= static_cast<uint8_t>(match_code >= 15 ? 15 : match_code);
+  dst[token_pos] = static_cast<char>(token);
+
+  if (literal_length >= 15 && !PutLength(literal_length - 15, dst, capacity, op)) {
+    return false;
+  }
+  if (*op + literal_length > capacity) {
+    return false;
+  }
+  memcpy(dst + *op, literals, literal_length);
+  *op += literal_length;
+
+  if (match_length == 0) {
+    return true;
+  }
+  if (*op + 2 > capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(offset & 0xFF);
+  dst[(*op)++] = static_cast<char>((offset >> 8) & 0xFF);
+  return match_code < 15 || PutLength(match_code - 15, dst, capacity, op);
+}
+
+}  // namespace
+
+size_t PageCompressor::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  int32_t table[HASH_TABLE_SIZE];
+  for (auto &entry : table) {
+    entry = -1;
+  }
+
+  size_t op = 0;
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + MIN_MATCH <= src_size) {
+    uint32_t sequence = Load32(src + i);
+    uint32_t h = Hash(sequence);
+    int32_t candidate = table[h];
+    table[h] = static_cast<int32_t>(i);
+
+    if (candidate < 0 || i - static_cast<size_t>(candidate) > MAX_OFFSET || Load32(src + candidate) != sequence) {
+      i++;
+      continue;
+    }
+    auto match_start = static_cast<size_t>(candidate);
+
+    // extend the match as far as it goes; the source may overlap the match itself
+    size_t match_length = MIN_MATCH;
+    while (i + match_length < src_size && src[match_start + match_length] == src[i + match_length]) {
+      match_length++;
+    }
+    if (!EmitSequence(src + anchor, i - anchor, i - match_start, match_length, dst, dst_capacity, &op)) {
+      return 0;
+    }
+    i += match_length;
+    anchor = i;
+  }
+
+  // the trailing literals always form the last record
+  if (!EmitSequence(src + anchor, src_size - anchor, 0, 0, dst, dst_capacity, &op)) {
+    return 0;
+  }
+  return op;
+}
+
+bool PageCompressor::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < src_size) {
+    auto token = static_cast<uint8_t>(src[ip++]);
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !GetLength(src, src_size, &ip, &literal_length)) {
+      return false;
+    }
+    if (ip + literal_length > src_size || op + literal_length > dst_size) {
+      return false;
+    }
+    memcpy(dst + op, src + ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+
+    if (ip == src_size) {
+      // last record
+      break;
+    }
+
+    if (ip + 2 > src_size) {
+      return false;
+    }
+    size_t offset = static_cast<uint8_t>(src[ip]) | (static_cast<size_t>(static_cast<uint8_t>(src[ip + 1])) << 8);
+    ip += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15 && !GetLength(src, src_size, &ip, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_length > dst_size) {
+      return false;
+    }
+    // byte by byte, since the match may overlap the bytes being produced
+    for (size_t k = 0; k < match_length; k++, op++) {
+      dst[op] = dst[op - offset];
+    }
+  }
+  return op == dst_size;
+}
+
+}  // namespace bustub
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager.cpp
+//
+// Identification: src/storage/disk/simulated_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/simulated_disk_manager.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+SimulatedDiskManager::SimulatedDiskManager(const DiskProfile &profile, bool real_time)
+    : profile_(profile),
+      real_time_(real_time),
+      start_(std::chrono::steady_clock::now()),
+      slot_free_us_(std::max(profile.queue_depth_, 1), 0) {}
+
+void SimulatedDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  WritePages(page_id, page_data, 1);
+}
+
+void SimulatedDiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadPages(page_id, page_data, 1); }
+
+void SimulatedDiskManager::WritePages(page_id_t first_page_id, const char *page_data, int num_pages) {
+  size_t size = static_cast<size_t>(num_pages) * PAGE_SIZE;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (int i = 0; i < num_pages; i++) {
+      auto &page = pages_[first_page_id + i];
+      if (page == nullptr) {
+        page = std::make_unique<char[]>(PAGE_SIZE);
+      }
+      memcpy(page.get(), page_data + static_cast<size_t>(i) * PAGE_SIZE, PAGE_SIZE);
+    }
+    num_writes_ += 1;
+    num_bytes_written_ += size;
+  }
+  Access(DiskAccess::Type::WRITE, first_page_id, num_pages, size);
+}
+
+void SimulatedDiskManager::ReadPages(page_id_t first_page_id, char *page_data, int num_pages) {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    for (int i = 0; i < num_pages; i++) {
+      char *dst = page_data + static_cast<size_t>(i) * PAGE_SIZE;
+      auto it = pages_.find(first_page_id + i);
+      if (it == pages_.end()) {
+        LOG_DEBUG("I/O error reading past end of file");
+        memset(dst, 0, PAGE_SIZE);
+      } else {
+        memcpy(dst, it->second.get(), PAGE_SIZE);
+      }
+    }
+  }
+  Access(DiskAccess::Type::READ, first_page_id, num_pages, static_cast<size_t>(num_pages) * PAGE_SIZE);
+}
+
+void SimulatedDiskManager::WriteLog(char *log_data, int size) {
+  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    flush_log_ = true;
+    num_flushes_ += 1;
+    log_.insert(log_.end(), log_data, log_data + size);
+  }
+  Access(DiskAccess::Type::LOG_WRITE, INVALID_PAGE_ID, 0, size);
+  std::lock_guard<std::mutex> lock(latch_);
+  flush_log_ = false;
+}
+
+bool SimulatedDiskManager::ReadLog(char *log_data, int size, int offset) {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+      return false;
+    }
+    size_t read_count = std::min(static_cast<size_t>(size), log_.size() - offset);
+    memcpy(log_data, log_.data() + offset, read_count);
+    memset(log_data + read_count, 0, size - read_count);
+  }
+  Access(DiskAccess::Type::LOG_READ, INVALID_PAGE_ID, 0, size);
+  return true;
+}
+
+void SimulatedDiskManager::DeallocatePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  pages_.erase(page_id);
+}
+
+uint64_t SimulatedDiskManager::GetElapsedTime() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return elapsed_us_;
+}
+
+std::vector<DiskAccess> SimulatedDiskManager::GetTrace() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return trace_;
+}
+
+void SimulatedDiskManager::EnableTrace(bool enable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  trace_enabled_ = enable;
+}
+
+void SimulatedDiskManager::ClearTrace() {
+  std::lock_guard<std::mutex> lock(latch_);
+  trace_.clear();
+}
+
+void SimulatedDiskManager::Access(DiskAccess::Type type, page_id_t page_id, int num_pages, size_t size) {
+  std::unique_lock<std::mutex> lock(latch_);
+  uint64_t issue = Now();
+
+  // wait for the queue slot that frees up first
+  auto slot = std::min_element(slot_free_us_.begin(), slot_free_us_.end());
+  uint64_t start = std::max(issue, *slot);
+
+  bool is_write = type == DiskAccess::Type::WRITE || type == DiskAccess::Type::LOG_WRITE;
+  uint64_t latency = is_write ? profile_.write_latency_us_ : profile_.read_latency_us_;
+  // the log lives on its own sequentially written region, page requests seek unless they continue the previous one
+  if (page_id != INVALID_PAGE_ID) {
+    if (page_id != next_sequential_page_) {
+      latency += profile_.seek_latency_us_;
+    }
+    next_sequential_page_ = page_id + num_pages;
+  }
+
+  uint64_t transfer = profile_.bandwidth_bytes_per_sec_ == 0 ? 0 : size * 1000000 / profile_.bandwidth_bytes_per_sec_;
+  uint64_t complete = std::max(start + latency, channel_free_us_) + transfer;
+  channel_free_us_ = complete;
+  *slot = complete;
+  elapsed_us_ = std::max(elapsed_us_, complete);
+  if (trace_enabled_) {
+    trace_.push_back(DiskAccess{type, page_id, num_pages, issue, complete});
+  }
+
+  if (!real_time_) {
+    thread_clocks_[std::this_thread::get_id()] = complete;
+    return;
+  }
+  lock.unlock();
+  std::this_thread::sleep_until(start_ + std::chrono::microseconds(complete));
+}
+
+uint64_t SimulatedDiskManager::Now() {
+  if (real_time_) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_).count();
+  }
+  return thread_clocks_[std::this_thread::get_id()];
+}
+
+}  // namespace bustub
@@ -0,0 +1,349 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_epsilon_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/index/b_epsilon_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+INDEX_TEMPLATE_ARGUMENTS
+B_EPSILON_TREE_TYPE::BEpsilonTree(std::string name, BufferPoolManager *buffer_pool_manager,
+                                  const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size) {
+  BUSTUB_ASSERT(leaf_max_size > 0 && leaf_max_size <= LeafPage::Capacity(), "Leaf size out of range");
+  BUSTUB_ASSERT(internal_max_size > 1 && InternalPage::BufferCapacity(internal_max_size) > 0,
+                "No room for a message buffer");
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_EPSILON_TREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Look key up in its leaf, then apply the messages buffered for it above the leaf, the deepest and so the oldest
+ * ones first.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_EPSILON_TREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  tree_latch_.RLock();
+  if (IsEmpty()) {
+    tree_latch_.RUnlock();
+    return false;
+  }
+
+  std::vector<std::vector<Message>> levels;
+  bool found = false;
+  ValueType value;
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      tree_latch_.RUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page");
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      found = reinterpret_cast<LeafPage *>(node)->Lookup(key, &value, comparator_);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      break;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    internal->FindMessages(key, comparator_, &levels.emplace_back());
+    page_id_t child_page_id = internal->ChildAt(internal->ChildIndex(key, comparator_));
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = child_page_id;
+  }
+  tree_latch_.RUnlock();
+
+  for (auto level = levels.rbegin(); level != levels.rend(); ++level) {
+    found = Resolve(level->data(), level->data() + level->size(), found, &value);
+  }
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_EPSILON_TREE_TYPE::Resolve(const Message *begin, const Message *end, bool found, ValueType *value) {
+  for (const Message *message = begin; message != end; ++message) {
+    switch (message->type_) {
+      case BEpsilonMessageType::INSERT:
+        if (!found) {
+          *value = message->value_;
+          found = true;
+        }
+        break;
+      case BEpsilonMessageType::UPSERT:
+        *value = message->value_;
+        found = true;
+        break;
+      case BEpsilonMessageType::DELETE:
+        found = false;
+        break;
+    }
+  }
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  AddMessage({key, value, BEpsilonMessageType::INSERT});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::Upsert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  AddMessage({key, value, BEpsilonMessageType::UPSERT});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  AddMessage({key, ValueType(), BEpsilonMessageType::DELETE});
+}
+
+/*
+ * Send a message in at the root. If the root splits, the tree grows a level, or more if the new root would have too
+ * many children.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::AddMessage(const Message &message) {
+  tree_latch_.WLock();
+  if (IsEmpty()) {
+    page_id_t page_id;
+    auto *leaf = reinterpret_cast<LeafPage *>(NewPage(&page_id)->GetData());
+    leaf->Init(page_id, leaf_max_size_);
+    root_page_id_ = page_id;
+    UpdateRootPageId(1);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+
+  std::vector<std::pair<KeyType, page_id_t>> siblings;
+  ApplyMessages(root_page_id_, {message}, &siblings);
+  bool grown = !siblings.empty();
+  while (!siblings.empty()) {
+    std::vector<KeyType> pivots{KeyType()};
+    std::vector<page_id_t> children{root_page_id_};
+    for (const auto &[key, page_id] : siblings) {
+      pivots.push_back(key);
+      children.push_back(page_id);
+    }
+    siblings.clear();
+    page_id_t page_id;
+    auto *root = reinterpret_cast<InternalPage *>(NewPage(&page_id)->GetData());
+    root->Init(page_id, internal_max_size_);
+    StoreInternal(root, pivots, children, {}, &siblings);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    root_page_id_ = page_id;
+  }
+  if (grown) {
+    UpdateRootPageId(0);
+  }
+  tree_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::ApplyMessages(page_id_t page_id, std::vector<Message> messages,
+                                        std::vector<std::pair<KeyType, page_id_t>> *siblings) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+  if (node->IsLeafPage()) {
+    // merge the messages into the pairs, resolving the messages of each key against its pair
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    std::vector<MappingType> pairs;
+    leaf->Load(&pairs);
+    std::vector<MappingType> result;
+    result.reserve(pairs.size() + messages.size());
+    size_t i = 0;
+    size_t j = 0;
+    while (i < pairs.size() || j < messages.size()) {
+      if (j == messages.size() || (i < pairs.size() && comparator_(pairs[i].first, messages[j].key_) < 0)) {
+        result.push_back(pairs[i++]);
+        continue;
+      }
+      size_t end = j + 1;
+      while (end < messages.size() && comparator_(messages[end].key_, messages[j].key_) == 0) {
+        end++;
+      }
+      bool found = false;
+      ValueType value;
+      if (i < pairs.size() && comparator_(pairs[i].first, messages[j].key_) == 0) {
+        found = true;
+        value = pairs[i++].second;
+      }
+      if (Resolve(messages.data() + j, messages.data() + end, found, &value)) {
+        result.emplace_back(messages[j].key_, value);
+      }
+      j = end;
+    }
+    StoreLeaf(leaf, result, siblings);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+
+  // usually the messages just join the buffer
+  auto *internal = reinterpret_cast<InternalPage *>(node);
+  if (internal->GetBufferSize() + messages.size() <= static_cast<size_t>(internal->BufferCapacity())) {
+    for (const auto &message : messages) {
+      internal->InsertMessage(message, comparator_);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+
+  // otherwise the largest batches for a single child are flushed until the rest fits; std::merge keeps the buffered
+  // messages of a key before the new ones
+  std::vector<KeyType> pivots;
+  std::vector<page_id_t> children;
+  std::vector<Message> buffer;
+  internal->Load(&pivots, &children, &buffer);
+  auto key_less = [this](const Message &a, const Message &b) { return comparator_(a.key_, b.key_) < 0; };
+  std::vector<Message> merged;
+  merged.reserve(buffer.size() + messages.size());
+  std::merge(buffer.begin(), buffer.end(), messages.begin(), messages.end(), std::back_inserter(merged), key_less);
+  auto pivot_less = [this](const Message &m, const KeyType &key) { return comparator_(m.key_, key) < 0; };
+  while (merged.size() > static_cast<size_t>(internal->BufferCapacity())) {
+    size_t child = 0;
+    auto best_begin = merged.begin();
+    auto best_end = merged.begin();
+    auto begin = merged.begin();
+    for (size_t i = 0; i < children.size(); i++) {
+      auto end = i + 1 < children.size() ? std::lower_bound(begin, merged.end(), pivots[i + 1], pivot_less)
+                                         : merged.end();
+      if (end - begin > best_end - best_begin) {
+        child = i;
+        best_begin = begin;
+        best_end = end;
+      }
+      begin = end;
+    }
+    std::vector<Message> batch(best_begin, best_end);
+    merged.erase(best_begin, best_end);
+    std::vector<std::pair<KeyType, page_id_t>> child_siblings;
+    ApplyMessages(children[child], std::move(batch), &child_siblings);
+    for (size_t i = 0; i < child_siblings.size(); i++) {
+      pivots.insert(pivots.begin() + child + 1 + i, child_siblings[i].first);
+      children.insert(children.begin() + child + 1 + i, child_siblings[i].second);
+    }
+  }
+  StoreInternal(internal, pivots, children, merged, siblings);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*
+ * Spread the pairs evenly over the leaf and as many new leaves as they need.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::StoreLeaf(LeafPage *leaf, const std::vector<MappingType> &pairs,
+                                    std::vector<std::pair<KeyType, page_id_t>> *siblings) {
+  size_t pieces = std::max<size_t>((pairs.size() + leaf_max_size_ - 1) / leaf_max_size_, 1);
+  leaf->Store(pairs.data(), pairs.size() / pieces);
+  for (size_t piece = 1; piece < pieces; piece++) {
+    size_t begin = piece * pairs.size() / pieces;
+    size_t end = (piece + 1) * pairs.size() / pieces;
+    page_id_t page_id;
+    auto *sibling = reinterpret_cast<LeafPage *>(NewPage(&page_id)->GetData());
+    sibling->Init(page_id, leaf_max_size_);
+    sibling->Store(pairs.data() + begin, end - begin);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    siblings->emplace_back(pairs[begin].first, page_id);
+  }
+}
+
+/*
+ * Spread the children evenly over the page and as many new pages as they need, each with the messages of its
+ * children.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::StoreInternal(InternalPage *internal, const std::vector<KeyType> &pivots,
+                                        const std::vector<page_id_t> &children, const std::vector<Message> &messages,
+                                        std::vector<std::pair<KeyType, page_id_t>> *siblings) {
+  auto pivot_less = [this](const Message &m, const KeyType &key) { return comparator_(m.key_, key) < 0; };
+  size_t pieces = (children.size() + internal_max_size_ - 1) / internal_max_size_;
+  size_t message = 0;
+  for (size_t piece = 0; piece < pieces; piece++) {
+    size_t begin = piece * children.size() / pieces;
+    size_t end = (piece + 1) * children.size() / pieces;
+    size_t message_end =
+        end < children.size()
+            ? std::lower_bound(messages.begin() + message, messages.end(), pivots[end], pivot_less) - messages.begin()
+            : messages.size();
+    InternalPage *target = internal;
+    page_id_t page_id = INVALID_PAGE_ID;
+    if (piece > 0) {
+      target = reinterpret_cast<InternalPage *>(NewPage(&page_id)->GetData());
+      target->Init(page_id, internal_max_size_);
+      siblings->emplace_back(pivots[begin], page_id);
+    }
+    target->Store(pivots.data() + begin, children.data() + begin, end - begin, messages.data() + message,
+                  message_end - message);
+    if (piece > 0) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    message = message_end;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *B_EPSILON_TREE_TYPE::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  return page;
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * Call this method everytime root page id is changed.
+ * @parameter: insert_record      defualt value is false. When set to true,
+ * insert a record<index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_TYPE::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (insert_record != 0) {
+    // create a new record<index_name + root_page_id> in header_page
+    header_page->InsertRecord(index_name_, root_page_id_);
+  } else {
+    // update root_page_id in header_page
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+template class BEpsilonTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BEpsilonTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BEpsilonTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BEpsilonTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,7 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -17,32 +22,148 @@
 #include "storage/page/header_page.h"
 
 namespace bustub {
+
+namespace {
+
+// rounds a rebuild catches up in while writers go on, at most, and the changed keys it is left to take with writers
+// held off, at most, when it stops early
+constexpr int REBUILD_CATCH_UP_ROUNDS = 8;
+constexpr size_t REBUILD_FINAL_KEYS = 64;
+
+}  // namespace
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool b_link, bool compress, bool unique,
+                          double merge_threshold)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      b_link_(b_link),
+      compress_(compress),
+      unique_(unique),
+      merge_threshold_(merge_threshold) {
+  BUSTUB_ASSERT(merge_threshold > 0 && merge_threshold <= 0.5, "Merge threshold out of range");
+  BUSTUB_ASSERT(!compress || (IsByteComparable<KeyType, KeyComparator>::value), "Keys do not compare bytewise");
+  BUSTUB_ASSERT(unique || (std::is_same_v<ValueType, RID>), "Posting lists hold record ids");
+  // the pairs of a key never take more than an eighth of a leaf, so that a leaf can always split between two keys
+  max_inline_values_ = std::max(1, (std::min(leaf_max_size_, LeafPage::Capacity(0)) - 1) / 8);
+  // an internal page holds one extra entry between an insertion and its split, compressing pages cap themselves
+  if (!compress_) {
+    internal_max_size_ = std::min(internal_max_size_, InternalPage::Capacity(0) - 1);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  StopCompaction();
+  freed_pages_.Retry(buffer_pool_manager_);
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that are associated with input key, a single one if keys are unique
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  Page *page =
+      b_link_ ? FindLeafPageBLink(key, Operation::READ) : FindLeafPageByOperation(key, Operation::READ, transaction);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool found = GetValuesFromPage(leaf, key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValuesFromPage(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result) {
+  int index = leaf->KeyIndex(key, comparator_);
+  int start = index;
+  for (; index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0; index++) {
+    ValueType value = leaf->ValueAt(index);
+    page_id_t posting_page_id;
+    if (!unique_ && BPlusTreePostingPage::IsReference(value, &posting_page_id)) {
+      AppendPostingList(posting_page_id, result);
+    } else {
+      result->push_back(value);
+    }
+  }
+  return index > start;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                              Transaction *transaction) {
+  // the leaves are walked from one to the next
+  auto generation = EnterGeneration();
+  results->resize(keys.size());
+  int found = 0;
+  Page *page = nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    const KeyType &key = keys[i];
+    if (page != nullptr) {
+      // the keys are sorted, so the leaf still holds key unless key reaches its high key
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      if (leaf->GetNextPageId() != INVALID_PAGE_ID && comparator_(key, leaf->GetHighKey()) >= 0) {
+        page = MoveToNextLeaf(page, key);
+      }
+    }
+    if (page == nullptr) {
+      page = b_link_ ? FindLeafPageBLink(key, Operation::READ)
+                     : FindLeafPageByOperation(key, Operation::READ, transaction);
+      if (page == nullptr) {
+        return found;
+      }
+    }
+    if (GetValuesFromPage(reinterpret_cast<LeafPage *>(page->GetData()), key, &(*results)[i])) {
+      found++;
+    }
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::MoveToNextLeaf(Page *page, const KeyType &key) {
+  // pin the next leaf before letting go of this one, which also starts reading it in if it is not buffered; as for
+  // index iterators, the latch on it is only taken after the one on this leaf is released
+  page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+  Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (next_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch right sibling page");
+  }
+  next_page->RLatch();
+
+  // meanwhile the next leaf may have given keys to its left sibling, or have been merged into it and left empty
+  auto *next = reinterpret_cast<LeafPage *>(next_page->GetData());
+  bool holds_key = (b_link_ || next->GetSize() > 0) && comparator_(next->GetLowKey(), key) <= 0 &&
+                   (next->GetNextPageId() == INVALID_PAGE_ID || comparator_(key, next->GetHighKey()) < 0);
+  if (holds_key) {
+    return next_page;
+  }
+  next_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, false);
+  return nullptr;
 }
 
 /*****************************************************************************
@@ -52,11 +173,56 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if user try to insert a duplicate key, or a duplicate pair if keys are
+ * not unique, return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (enable_compaction_) {
+    write_count_++;
+  }
+  if (b_link_) {
+    return InsertBLink(key, value);
+  }
+  rebuild_latch_.RLock();
+  bool inserted = InsertEntry(key, value, transaction);
+  if (inserted) {
+    LogRebuildKey(key);
+  }
+  rebuild_latch_.RUnlock();
+  return inserted;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertEntry(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  // most insertions do not split the leaf, try them with only the leaf write latched first
+  Page *page = FindLeafPageOptimistic(key);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    LeafChange change = InsertIntoPage(leaf, key, value, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), change == LeafChange::DONE);
+    if (change != LeafChange::NOT_SAFE) {
+      return change == LeafChange::DONE;
+    }
+  }
+
+  // the tree is empty or the leaf has to split, restart and crab down with write latches
+  root_latch_.WLock();
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    root_latch_.WUnlock();
+    return true;
+  }
+  root_latch_.WUnlock();
+
+  // crabbing keeps its latched pages in a transaction, borrow one if the caller has none
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    return InsertIntoLeaf(key, value, &local_transaction);
+  }
+  return InsertIntoLeaf(key, value, transaction);
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,19 +230,93 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t root_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_, compress_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = root_page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(root_page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if user try to insert a duplicate key, or a duplicate pair if keys are
+ * not unique, return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  Page *page = FindLeafPageByOperation(key, Operation::INSERT, transaction);
+  if (page == nullptr) {
+    // the tree was emptied after Insert() looked at it
+    return InsertEntry(key, value, transaction);
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+
+  if (InsertIntoPage(leaf, key, value, false) == LeafChange::NONE) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+
+  if (leaf->GetSize() >= leaf->GetMaxSize()) {
+    LeafPage *new_leaf = Split(leaf);
+    InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+    buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  }
+  ReleaseLatchedPages(transaction, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::LeafChange BPLUSTREE_TYPE::InsertIntoPage(LeafPage *leaf, const KeyType &key,
+                                                                   const ValueType &value, bool only_if_safe) {
+  int index = leaf->KeyIndex(key, comparator_);
+  int end = index;
+  while (end < leaf->GetSize() && comparator_(leaf->KeyAt(end), key) == 0) {
+    end++;
+  }
+  if (end > index) {
+    if (unique_) {
+      return LeafChange::NONE;
+    }
+    page_id_t posting_page_id;
+    if (BPlusTreePostingPage::IsReference(leaf->ValueAt(index), &posting_page_id)) {
+      return InsertIntoPostingList(posting_page_id, value) ? LeafChange::DONE : LeafChange::NONE;
+    }
+    int start = index;
+    while (index < end && BPlusTreePostingPage::Less(leaf->ValueAt(index), value)) {
+      index++;
+    }
+    if (index < end && leaf->ValueAt(index) == value) {
+      return LeafChange::NONE;
+    }
+    if (end - start >= max_inline_values_) {
+      // the values move to a posting list, which shrinks the leaf and is always safe
+      std::vector<ValueType> values;
+      for (int i = start; i < end; i++) {
+        values.push_back(leaf->ValueAt(i));
+      }
+      values.insert(values.begin() + (index - start), value);
+      for (int i = start + 1; i < end; i++) {
+        leaf->RemoveAt(start + 1);
+      }
+      leaf->SetValueAt(start, BPlusTreePostingPage::MakeReference(CreatePostingList(values)));
+      return LeafChange::DONE;
+    }
+  }
+  if (only_if_safe && !IsSafe(leaf, Operation::INSERT)) {
+    return LeafChange::NOT_SAFE;
+  }
+  leaf->InsertAt(index, key, value);
+  return LeafChange::DONE;
 }
 
 /*
@@ -85,11 +325,29 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page becomes the right sibling of the input page, the pages set their fences as they move pairs.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+  page_id_t new_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  // nobody can reach the new page before the parent points to it, so it is not latched
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(new_page_id, node->GetParentPageId(), leaf_max_size_, compress_);
+    node->MoveHalfTo(new_node, comparator_);
+  } else {
+    new_node->Init(new_page_id, node->GetParentPageId(), internal_max_size_, compress_);
+    node->MoveHalfTo(new_node, b_link_ ? nullptr : buffer_pool_manager_);
+    pinned_pages_stale_ = true;
+  }
+  new_node->SetNextPageId(node->GetNextPageId());
+  node->SetNextPageId(new_page_id);
+  return new_node;
 }
 
 /*
@@ -103,7 +361,194 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    // the root was not safe, so root_latch_ is still held
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, compress_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // the parent was not released either, it is latched by this operation
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  new_node->SetParentPageId(parent_page_id);
+  if (parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId()) > parent->GetMaxSize()) {
+    InternalPage *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  BUSTUB_ASSERT(fill_factor > 0 && fill_factor <= 1, "Fill factor must be in (0, 1]");
+  // a rebuild would not see the pairs, which are not logged
+  rebuild_latch_.RLock();
+  root_latch_.WLock();
+  if (!IsEmpty() || rebuilding_) {
+    root_latch_.WUnlock();
+    rebuild_latch_.RUnlock();
+    return false;
+  }
+
+  // a leaf holds at most max size - 1 pairs, an internal page at least two children; compressing pages are filled to
+  // what fits without a prefix and only take more pairs once they are in the tree
+  int leaf_max_size = compress_ ? std::min(leaf_max_size_, LeafPage::Capacity(0)) : leaf_max_size_;
+  int internal_max_size = compress_ ? std::min(internal_max_size_, InternalPage::Capacity(0) - 1) : internal_max_size_;
+  int leaf_fill = std::clamp(static_cast<int>(fill_factor * (leaf_max_size - 1)), 1, leaf_max_size - 1);
+  int internal_fill = std::clamp(static_cast<int>(fill_factor * internal_max_size), 2, internal_max_size);
+  BufferPoolManager *adopter = b_link_ ? nullptr : buffer_pool_manager_;
+
+  // first key and page id of every page of the level that was built last
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  LeafPage *prev_leaf = nullptr;
+  LeafPage *leaf = nullptr;
+  // the pairs of a key are added together, to a new leaf unless they fit the current one
+  auto add_pairs = [&](const KeyType &key, const std::vector<ValueType> &values) {
+    if (leaf == nullptr || leaf->GetSize() + static_cast<int>(values.size()) > leaf_fill) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+      }
+      auto *new_leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      new_leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, compress_);
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(page_id);
+        leaf->SetFences(leaf->GetLowKey(), key);
+        new_leaf->SetFences(key, new_leaf->GetHighKey());
+      }
+      if (prev_leaf != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+      }
+      prev_leaf = leaf;
+      leaf = new_leaf;
+      level.emplace_back(key, page_id);
+    }
+    for (const ValueType &value : values) {
+      leaf->InsertAt(leaf->GetSize(), key, value);
+    }
+  };
+
+  KeyType key;
+  ValueType value;
+  std::vector<ValueType> values;
+  bool more = next(&key, &value);
+  while (more) {
+    KeyType group_key = key;
+    values.clear();
+    values.push_back(value);
+    while ((more = next(&key, &value))) {
+      int order = comparator_(key, group_key);
+      BUSTUB_ASSERT(order >= 0, "Bulk load input must be sorted");
+      if (order != 0) {
+        break;
+      }
+      if (!unique_ && !(value == values.back())) {
+        BUSTUB_ASSERT(BPlusTreePostingPage::Less(values.back(), value), "Bulk load values must be sorted");
+        values.push_back(value);
+      }
+    }
+    if (static_cast<int>(values.size()) > max_inline_values_) {
+      values.assign(1, BPlusTreePostingPage::MakeReference(CreatePostingList(values)));
+    }
+    add_pairs(group_key, values);
+  }
+
+  if (leaf == nullptr) {
+    root_latch_.WUnlock();
+    rebuild_latch_.RUnlock();
+    return true;
+  }
+  // the last leaf takes pairs from its left sibling rather than stay below min size, the pairs of a key move together
+  if (prev_leaf != nullptr && leaf->GetSize() < leaf->GetMinSize()) {
+    while (true) {
+      int last = prev_leaf->GetSize() - 1;
+      int run = 1;
+      while (run <= last && comparator_(prev_leaf->KeyAt(last - run), prev_leaf->KeyAt(last)) == 0) {
+        run++;
+      }
+      if (prev_leaf->GetSize() - run < leaf->GetSize() + run) {
+        break;
+      }
+      for (int i = 0; i < run; i++) {
+        prev_leaf->MoveLastToFrontOf(leaf);
+      }
+    }
+    level.back().first = leaf->KeyAt(0);
+  }
+  if (prev_leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+
+  int internal_min_size = (internal_max_size + 1) / 2;
+  while (level.size() > 1) {
+    // page sizes of the new level, the last page shares with its left sibling rather than stay below min size
+    int num_children = static_cast<int>(level.size());
+    std::vector<int> sizes(num_children / internal_fill, internal_fill);
+    if (num_children % internal_fill != 0) {
+      sizes.push_back(num_children % internal_fill);
+    }
+    if (sizes.size() > 1 && sizes.back() < internal_min_size) {
+      int rest = sizes[sizes.size() - 2] + sizes.back();
+      sizes.pop_back();
+      sizes.back() = rest;
+      if (rest > internal_max_size) {
+        sizes.back() = rest - rest / 2;
+        sizes.push_back(rest / 2);
+      }
+    }
+
+    std::vector<std::pair<KeyType, page_id_t>> parents;
+    InternalPage *prev_node = nullptr;
+    auto child = level.begin();
+    for (int size : sizes) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+      }
+      auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+      node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, compress_);
+      parents.emplace_back(child->first, page_id);
+      if (prev_node != nullptr) {
+        prev_node->SetNextPageId(page_id);
+        prev_node->SetFences(prev_node->GetLowKey(), child->first);
+        node->SetFences(child->first, node->GetHighKey());
+        buffer_pool_manager_->UnpinPage(prev_node->GetPageId(), true);
+      }
+      for (int i = 0; i < size; i++, child++) {
+        node->Append(child->first, child->second, adopter);
+      }
+      prev_node = node;
+    }
+    buffer_pool_manager_->UnpinPage(prev_node->GetPageId(), true);
+    level = std::move(parents);
+  }
+
+  root_page_id_ = level.front().second;
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+  rebuild_latch_.RUnlock();
+  return true;
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +561,105 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  rebuild_latch_.RLock();
+  RemoveEntry(key, nullptr, transaction);
+  LogRebuildKey(key);
+  rebuild_latch_.RUnlock();
+}
+
+/*
+ * Delete only the pair of input key and value, the key stays if it has other values
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  rebuild_latch_.RLock();
+  RemoveEntry(key, &value, transaction);
+  LogRebuildKey(key);
+  rebuild_latch_.RUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  if (b_link_) {
+    RemoveBLink(key, value);
+    return;
+  }
+  if (enable_compaction_) {
+    write_count_++;
+  }
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    RemoveEntry(key, value, &local_transaction);
+    return;
+  }
+
+  // most removals leave the leaf above min size, try them with only the leaf write latched first
+  Page *page = FindLeafPageOptimistic(key);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  LeafChange change = RemoveFromPage(leaf, key, value, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), change == LeafChange::DONE);
+  if (change != LeafChange::NOT_SAFE) {
+    return;
+  }
+
+  // the leaf may underflow, restart and crab down with write latches
+  page = FindLeafPageByOperation(key, Operation::DELETE, transaction);
+  if (page == nullptr) {
+    return;
+  }
+  leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (RemoveFromPage(leaf, key, value, false) == LeafChange::NONE) {
+    ReleaseLatchedPages(transaction, false);
+    return;
+  }
+  if (CoalesceOrRedistribute(leaf, transaction)) {
+    transaction->AddIntoDeletedPageSet(leaf->GetPageId());
+  }
+  ReleaseLatchedPages(transaction, true);
+  DeletePages(transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::LeafChange BPLUSTREE_TYPE::RemoveFromPage(LeafPage *leaf, const KeyType &key,
+                                                                   const ValueType *value, bool only_if_safe) {
+  int start = leaf->KeyIndex(key, comparator_);
+  int end = start;
+  while (end < leaf->GetSize() && comparator_(leaf->KeyAt(end), key) == 0) {
+    end++;
+  }
+  if (end == start) {
+    return LeafChange::NONE;
+  }
+  page_id_t posting_page_id;
+  if (value != nullptr) {
+    if (!unique_ && BPlusTreePostingPage::IsReference(leaf->ValueAt(start), &posting_page_id)) {
+      // the leaf keeps its pair for the posting list, so this is always safe
+      return RemoveFromPostingList(leaf, start, *value) ? LeafChange::DONE : LeafChange::NONE;
+    }
+    while (start < end && !(leaf->ValueAt(start) == *value)) {
+      start++;
+    }
+    if (start == end) {
+      return LeafChange::NONE;
+    }
+    end = start + 1;
+  }
+  if (only_if_safe && !IsSafe(leaf, Operation::DELETE, end - start)) {
+    return LeafChange::NOT_SAFE;
+  }
+  for (int i = start; i < end; i++) {
+    if (!unique_ && BPlusTreePostingPage::IsReference(leaf->ValueAt(start), &posting_page_id)) {
+      DeletePostingList(posting_page_id);
+    }
+    leaf->RemoveAt(start);
+  }
+  return LeafChange::DONE;
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -127,8 +670,56 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, bool compact) {
+  if (node->IsRootPage()) {
+    return AdjustRoot(node);
+  }
+  if (node->GetSize() >= (compact ? node->GetMinSize() : MinSize(node))) {
+    return false;
+  }
+
+  // node underflows, so its parent is still latched by this operation; the sibling has to be latched here
+  page_id_t node_page_id = node->GetPageId();
+  Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent->ValueIndex(node_page_id);
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // a leaf has to stay below max size, an internal page may be full; compressing pages hold less between wider fences
+  N *left = index == 0 ? node : sibling;
+  N *right = index == 0 ? sibling : node;
+  int reserve = node->IsLeafPage() ? 1 : 0;
+  bool node_deleted = false;
+  if (sibling->GetSize() + node->GetSize() <= left->MaxSizeFor(left->GetLowKey(), right->GetHighKey()) - reserve) {
+    if (Coalesce(&sibling, &node, &parent, index, transaction)) {
+      transaction->AddIntoDeletedPageSet(parent->GetPageId());
+    }
+    // node now points to the right one of the two pages, whose entries moved to the left one
+    if (node->GetPageId() == node_page_id) {
+      node_deleted = true;
+    } else {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+  } else if (!compact) {
+    // the pair node takes from its sibling moves the fence between them, which must not split the pairs of a key
+    KeyType low_key = index == 0 ? node->GetLowKey() : sibling->KeyAt(sibling->GetSize() - 1);
+    KeyType high_key = index == 0 ? sibling->KeyAt(1) : node->GetHighKey();
+    bool splits_key = false;
+    if (!unique_ && node->IsLeafPage()) {
+      splits_key = comparator_(index == 0 ? sibling->KeyAt(0) : sibling->KeyAt(sibling->GetSize() - 2),
+                               index == 0 ? high_key : low_key) == 0;
+    }
+    if (!splits_key && node->GetSize() + 1 <= node->MaxSizeFor(low_key, high_key) - reserve) {
+      Redistribute(sibling, node, index);
+    }
+  }
+
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return node_deleted;
 }
 
 /*
@@ -142,13 +733,25 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * @param   parent             parent page of input "node"
  * @return  true means parent node should be deleted, false means no deletion
  * happend
+ * NOTE: pages are always merged from right to left. If node is the first child, neighbor_node and node are swapped
+ * so that on return *node is the page that was emptied.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
-  return false;
+  if (index == 0) {
+    std::swap(*neighbor_node, *node);
+    index = 1;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(index);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
@@ -162,7 +765,26 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(parent_page_id)->GetData());
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +796,372 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  // the root was not safe, so root_latch_ is still held
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    auto *old_root = reinterpret_cast<InternalPage *>(old_root_node);
+    root_page_id_ = old_root->RemoveAndReturnOnlyChild();
+    UpdateRootPageId(0);
+    auto *new_root = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+    new_root->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    return true;
+  }
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+/*
+ * Walk the leaves from left to right and merge the ones below half full with a sibling, one write latched descent
+ * per merge. A merged leaf is looked at again, since it may still be below half full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::Compact() {
+  if (b_link_) {
+    return 0;
+  }
+  Transaction transaction(INVALID_TXN_ID);
+  int merged = 0;
+  KeyType key;
+  bool left_most = true;
+  while (true) {
+    Page *page = FindLeafPage(key, left_most);
+    if (page == nullptr) {
+      return merged;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool sparse = !leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize();
+    page_id_t next_page_id = leaf->GetNextPageId();
+    KeyType high_key = leaf->GetHighKey();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    if (sparse && CompactLeaf(key, left_most, &transaction)) {
+      merged++;
+      continue;
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      return merged;
+    }
+    key = high_key;
+    left_most = false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CompactLeaf(const KeyType &key, bool left_most, Transaction *transaction) {
+  // the tree compacted is not swapped out meanwhile
+  rebuild_latch_.RLock();
+  Page *page = FindLeafPageByOperation(key, Operation::COMPACT, transaction, left_most);
+  if (page == nullptr) {
+    rebuild_latch_.RUnlock();
+    return false;
+  }
+  // the leaf may have changed since it was found sparse
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (!leaf->IsRootPage() && CoalesceOrRedistribute(leaf, transaction, true)) {
+    transaction->AddIntoDeletedPageSet(leaf->GetPageId());
+  }
+  bool merged = !transaction->GetDeletedPageSet()->empty();
+  ReleaseLatchedPages(transaction, merged);
+  DeletePages(transaction);
+  rebuild_latch_.RUnlock();
+  return merged;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartCompaction() {
+  if (!enable_compaction_.exchange(true)) {
+    compaction_thread_ = std::thread(&BPLUSTREE_TYPE::RunCompaction, this);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopCompaction() {
+  if (enable_compaction_.exchange(false)) {
+    compaction_thread_.join();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RunCompaction() {
+  uint64_t last_write_count = write_count_;
+  bool compacted = false;
+  while (enable_compaction_) {
+    std::this_thread::sleep_for(compaction_interval);
+    // compact once per idle period, the tree does not change while it lasts
+    uint64_t write_count = write_count_;
+    if (write_count != last_write_count) {
+      last_write_count = write_count;
+      compacted = false;
+    } else if (!compacted) {
+      Compact();
+      compacted = true;
+    }
+  }
+}
+
+/*****************************************************************************
+ * REBUILD
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Rebuild(double fill_factor) {
+  if (b_link_) {
+    return false;
+  }
+  rebuild_latch_.WLock();
+  if (rebuilding_) {
+    rebuild_latch_.WUnlock();
+    return false;
+  }
+  // writers that come after log their keys
+  rebuilding_ = true;
+  rebuild_latch_.WUnlock();
+
+  BPlusTree copy(index_name_, buffer_pool_manager_, comparator_, leaf_max_size_, internal_max_size_, false, compress_,
+                 unique_, merge_threshold_);
+  copy.persist_root_ = false;
+
+  // one leaf at a time, from the high key of the one before, so that a pair moved by a split is read once
+  std::vector<MappingType> pairs;
+  size_t next_pair = 0;
+  KeyType key;
+  bool left_most = true;
+  bool last_leaf = false;
+  copy.BulkLoad(
+      [&](KeyType *next_key, ValueType *next_value) {
+        while (next_pair == pairs.size()) {
+          if (last_leaf) {
+            return false;
+          }
+          pairs.clear();
+          next_pair = 0;
+          Page *page = FindLeafPage(key, left_most);
+          if (page == nullptr) {
+            return false;
+          }
+          auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+          for (int i = 0; i < leaf->GetSize(); i++) {
+            if (!left_most && comparator_(leaf->KeyAt(i), key) < 0) {
+              continue;
+            }
+            page_id_t posting_page_id;
+            if (!unique_ && BPlusTreePostingPage::IsReference(leaf->ValueAt(i), &posting_page_id)) {
+              std::vector<ValueType> values;
+              AppendPostingList(posting_page_id, &values);
+              for (const ValueType &value : values) {
+                pairs.emplace_back(leaf->KeyAt(i), value);
+              }
+            } else {
+              pairs.emplace_back(leaf->KeyAt(i), leaf->ValueAt(i));
+            }
+          }
+          last_leaf = leaf->GetNextPageId() == INVALID_PAGE_ID;
+          key = leaf->GetHighKey();
+          left_most = false;
+          page->RUnlatch();
+          buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        }
+        *next_key = pairs[next_pair].first;
+        *next_value = pairs[next_pair].second;
+        next_pair++;
+        return true;
+      },
+      fill_factor);
+
+  // catch up while writers go on, as long as that shrinks what is left for the round that holds them off
+  std::vector<KeyType> keys;
+  for (int round = 0; round < REBUILD_CATCH_UP_ROUNDS; round++) {
+    {
+      std::lock_guard<std::mutex> guard(rebuild_log_latch_);
+      keys.swap(rebuild_log_);
+    }
+    if (keys.size() <= REBUILD_FINAL_KEYS) {
+      break;
+    }
+    CatchUp(&copy, &keys);
+  }
+
+  rebuild_latch_.WLock();
+  keys.insert(keys.end(), rebuild_log_.begin(), rebuild_log_.end());
+  rebuild_log_.clear();
+  CatchUp(&copy, &keys);
+  rebuilding_ = false;
+  root_latch_.WLock();
+  page_id_t old_root_page_id = root_page_id_;
+  root_page_id_ = copy.root_page_id_;
+  // an empty tree stays empty, the copy holds what the tree does
+  if (old_root_page_id != INVALID_PAGE_ID) {
+    UpdateRootPageId(0);
+  }
+  root_latch_.WUnlock();
+  rebuild_latch_.WUnlock();
+  copy.root_page_id_ = INVALID_PAGE_ID;
+
+  // readers that come after find the copy, the old pages go once those that came before are done
+  auto generation = std::make_shared<Generation>(this);
+  auto old_generation = std::atomic_exchange(&generation_, generation);
+  old_generation->retired_root_page_id_ = old_root_page_id;
+  old_generation->next_ = std::move(generation);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LogRebuildKey(const KeyType &key) {
+  if (rebuilding_) {
+    std::lock_guard<std::mutex> guard(rebuild_log_latch_);
+    rebuild_log_.push_back(key);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CatchUp(BPlusTree *copy, std::vector<KeyType> *keys) {
+  std::sort(keys->begin(), keys->end(),
+            [this](const KeyType &a, const KeyType &b) { return comparator_(a, b) < 0; });
+  keys->erase(std::unique(keys->begin(), keys->end(),
+                          [this](const KeyType &a, const KeyType &b) { return comparator_(a, b) == 0; }),
+              keys->end());
+  std::vector<ValueType> values;
+  for (const KeyType &key : *keys) {
+    values.clear();
+    GetValue(key, &values);
+    copy->Remove(key);
+    for (const ValueType &value : values) {
+      copy->Insert(key, value);
+    }
+  }
+  keys->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::Generation::~Generation() {
+  if (retired_root_page_id_ != INVALID_PAGE_ID) {
+    tree_->FreeTree(retired_root_page_id_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreeTree(page_id_t root_page_id) {
+  std::vector<page_id_t> level;
+  if (root_page_id != INVALID_PAGE_ID) {
+    level.push_back(root_page_id);
+  }
+  std::vector<page_id_t> next_level;
+  while (!level.empty()) {
+    for (page_id_t page_id : level) {
+      Page *page = buffer_pool_manager_->FetchPage(page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page");
+      }
+      page->WLatch();
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (!node->IsLeafPage()) {
+        auto *internal = reinterpret_cast<InternalPage *>(node);
+        for (int i = 0; i < internal->GetSize(); i++) {
+          next_level.push_back(internal->ValueAt(i));
+        }
+      } else if (!unique_) {
+        auto *leaf = reinterpret_cast<LeafPage *>(node);
+        for (int i = 0; i < leaf->GetSize(); i++) {
+          page_id_t posting_page_id;
+          if (BPlusTreePostingPage::IsReference(leaf->ValueAt(i), &posting_page_id)) {
+            DeletePostingList(posting_page_id);
+          }
+        }
+      }
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      FreePage(page_id);
+    }
+    level.swap(next_level);
+    next_level.clear();
+  }
+}
+
+/*****************************************************************************
+ * STATISTICS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectStatistics(IndexStatisticsCollector *collector,
+                                       const std::function<Value(const KeyType &)> &first_column) {
+  auto generation = EnterGeneration();
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  // the latch order of FindLeafPageBefore, a leftmost page stays leftmost in B-link mode
+  if (b_link_) {
+    root_latch_.RUnlock();
+    page->RLatch();
+  } else {
+    page->RLatch();
+    root_latch_.RUnlock();
+  }
+
+  // all leaves are at the same depth, the leftmost path gives the height
+  uint32_t height = 1;
+  while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    Page *child_page = buffer_pool_manager_->FetchPage(reinterpret_cast<InternalPage *>(page->GetData())->ValueAt(0));
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    if (b_link_) {
+      page->RUnlatch();
+      child_page->RLatch();
+    } else {
+      child_page->RLatch();
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    height++;
+  }
+  collector->SetHeight(height);
+
+  HashFunction<KeyType> hash_fn;
+  std::vector<ValueType> postings;
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    collector->AddPage(leaf->GetSize(), leaf->GetMaxSize());
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      KeyType key = leaf->KeyAt(i);
+      uint64_t count = 1;
+      page_id_t posting_page_id;
+      if (!unique_ && BPlusTreePostingPage::IsReference(leaf->ValueAt(i), &posting_page_id)) {
+        postings.clear();
+        AppendPostingList(posting_page_id, &postings);
+        count = postings.size();
+      }
+      if (first_column) {
+        Value value = first_column(key);
+        collector->AddKey(hash_fn.GetHash(key), &value, count);
+      } else {
+        collector->AddKey(hash_fn.GetHash(key), nullptr, count);
+      }
+    }
+    // as an iterator moves on, the next leaf is pinned first but only latched once this one is released
+    page_id_t next_page_id = leaf->GetNextPageId();
+    Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (next_page != nullptr) {
+      next_page->RLatch();
+    }
+    page = next_page;
+  }
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +1172,11 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
+  auto generation = EnterGeneration();
+  Page *page = FindLeafPage(KeyType(), true);
+  return INDEXITERATOR_TYPE(this, std::move(generation), page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +1184,15 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  auto generation = EnterGeneration();
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(this, std::move(generation), page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,6 +1202,197 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Find the rightmost leaf page and construct a reverse index iterator starting at its last pair
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::rbegin() {
+  auto generation = EnterGeneration();
+  bool left_most;
+  Page *page = FindLeafPageBefore(KeyType(), true, &left_most);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->GetSize() - 1;
+  return INDEXITERATOR_TYPE(this, std::move(generation), page, index, true, left_most);
+}
+
+/*
+ * Find the leaf page of the first key to return, low or for a reverse iterator the last key below high, and
+ * construct an index iterator that checks the other end of the range itself
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Range(const KeyType &low, const KeyType &high, bool reverse) {
+  auto generation = EnterGeneration();
+  bool left_most = false;
+  Page *page = reverse ? FindLeafPageBefore(high, false, &left_most) : FindLeafPage(low);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (reverse) {
+    int index = leaf->KeyIndex(high, comparator_) - 1;
+    return INDEXITERATOR_TYPE(this, std::move(generation), page, index, true, left_most, &low);
+  }
+  int index = leaf->KeyIndex(low, comparator_);
+  return INDEXITERATOR_TYPE(this, std::move(generation), page, index, false, false, &high);
+}
+
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreePostingPage *BPLUSTREE_TYPE::FetchPostingPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch posting page");
+  }
+  return reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+}
+
+/*
+ * Fill new pages with the values, which are sorted, and link them
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::CreatePostingList(const std::vector<ValueType> &values) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  BPlusTreePostingPage *prev = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (size_t i = 0; i < values.size(); i += POSTING_PAGE_SIZE) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+    posting->Init();
+    for (size_t j = i; j < values.size() && j < i + POSTING_PAGE_SIZE; j++) {
+      posting->Append(values[j]);
+    }
+    if (prev == nullptr) {
+      first_page_id = page_id;
+    } else {
+      prev->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+    prev = posting;
+    prev_page_id = page_id;
+  }
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  return first_page_id;
+}
+
+/*
+ * Insert into the first page whose last value is not less than value, or the last page. A full page splits in two.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIntoPostingList(page_id_t page_id, const ValueType &value) {
+  BPlusTreePostingPage *posting = FetchPostingPage(page_id);
+  while (posting->GetNextPageId() != INVALID_PAGE_ID &&
+         BPlusTreePostingPage::Less(posting->ValueAt(posting->GetSize() - 1), value)) {
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    posting = FetchPostingPage(page_id);
+  }
+  if (posting->Contains(value)) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  if (posting->IsFull()) {
+    page_id_t new_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&new_page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    auto *new_posting = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+    new_posting->Init();
+    posting->MoveHalfTo(new_posting);
+    posting->SetNextPageId(new_page_id);
+    if (BPlusTreePostingPage::Less(new_posting->ValueAt(0), value)) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      page_id = new_page_id;
+      posting = new_posting;
+    } else {
+      buffer_pool_manager_->UnpinPage(new_page_id, true);
+    }
+  }
+  posting->Insert(value);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromPostingList(LeafPage *leaf, int index, const ValueType &value) {
+  page_id_t first_page_id;
+  BPlusTreePostingPage::IsReference(leaf->ValueAt(index), &first_page_id);
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t page_id = first_page_id;
+  BPlusTreePostingPage *posting = FetchPostingPage(page_id);
+  while (posting->GetNextPageId() != INVALID_PAGE_ID &&
+         BPlusTreePostingPage::Less(posting->ValueAt(posting->GetSize() - 1), value)) {
+    prev_page_id = page_id;
+    page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    posting = FetchPostingPage(page_id);
+  }
+  if (!posting->Remove(value)) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  // an emptied page is unlinked
+  if (posting->GetSize() == 0) {
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    buffer_pool_manager_->DeletePage(page_id);
+    if (prev_page_id == INVALID_PAGE_ID) {
+      first_page_id = next_page_id;
+      leaf->SetValueAt(index, BPlusTreePostingPage::MakeReference(first_page_id));
+    } else {
+      FetchPostingPage(prev_page_id)->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    }
+  } else {
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+
+  // the last value of a posting list goes back into the leaf
+  BPlusTreePostingPage *first = FetchPostingPage(first_page_id);
+  if (first->GetNextPageId() == INVALID_PAGE_ID && first->GetSize() == 1) {
+    leaf->SetValueAt(index, first->ValueAt(0));
+    buffer_pool_manager_->UnpinPage(first_page_id, false);
+    buffer_pool_manager_->DeletePage(first_page_id);
+  } else {
+    buffer_pool_manager_->UnpinPage(first_page_id, false);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AppendPostingList(page_id_t page_id, std::vector<ValueType> *result) {
+  while (page_id != INVALID_PAGE_ID) {
+    BPlusTreePostingPage *posting = FetchPostingPage(page_id);
+    for (int i = 0; i < posting->GetSize(); i++) {
+      result->push_back(posting->ValueAt(i));
+    }
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePostingList(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    page_id_t next_page_id = FetchPostingPage(page_id)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -212,7 +1402,576 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  if (b_link_) {
+    return FindLeafPageBLink(key, Operation::READ, nullptr, leftMost);
+  }
+  return FindLeafPageByOperation(key, Operation::READ, nullptr, leftMost);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &key, Operation op, Transaction *transaction,
+                                              bool left_most) {
+  // writes keep going through the buffer pool, their page set is unpinned there
+  std::shared_ptr<PinnedPages> pinned;
+  if (op == Operation::READ) {
+    pinned = GetPinnedPages();
+    root_latch_.RLock();
+  } else {
+    root_latch_.WLock();
+    transaction->AddIntoPageSet(nullptr);
+  }
+  if (IsEmpty()) {
+    if (op == Operation::READ) {
+      root_latch_.RUnlock();
+    } else {
+      ReleaseLatchedPages(transaction, false);
+    }
+    return nullptr;
+  }
+
+  Page *page = FetchPage(root_page_id_, pinned.get());
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  if (op == Operation::READ) {
+    page->RLatch();
+    root_latch_.RUnlock();
+  } else {
+    page->WLatch();
+    if (IsSafe(reinterpret_cast<BPlusTreePage *>(page->GetData()), op)) {
+      ReleaseLatchedPages(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+  }
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    Page *child_page = FetchPage(child_page_id, pinned.get());
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (op == Operation::READ) {
+      child_page->RLatch();
+      page->RUnlatch();
+      UnpinPage(page, pinned.get());
+    } else {
+      child_page->WLatch();
+      if (IsSafe(child, op)) {
+        ReleaseLatchedPages(transaction, false);
+      }
+      transaction->AddIntoPageSet(child_page);
+    }
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType &key, bool right_most, bool *left_most) {
+  std::shared_ptr<PinnedPages> pinned = GetPinnedPages();
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_, pinned.get());
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  // in B-link mode a writer may hold the root while waiting for root_latch_, which it then needs to grow the tree
+  if (b_link_) {
+    root_latch_.RUnlock();
+    page->RLatch();
+  } else {
+    page->RLatch();
+    root_latch_.RUnlock();
+  }
+
+  // the root is the leftmost page of its level, and so is the first child of a leftmost page
+  *left_most = true;
+  while (true) {
+    if (b_link_) {
+      page_id_t page_id = page->GetPageId();
+      page = MoveRight(page, key, false, true, right_most);
+      *left_most = *left_most && page->GetPageId() == page_id;
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id =
+        right_most ? internal->ValueAt(internal->GetSize() - 1) : internal->LookupBefore(key, comparator_);
+    *left_most = *left_most && child_page_id == internal->ValueAt(0);
+    Page *child_page = FetchPage(child_page_id, pinned.get());
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    // B-link writers latch parents while holding children, so there a reader lets go of the parent first
+    if (b_link_) {
+      page->RUnlatch();
+      child_page->RLatch();
+    } else {
+      child_page->RLatch();
+      page->RUnlatch();
+    }
+    UnpinPage(page, pinned.get());
+    page = child_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key) {
+  std::shared_ptr<PinnedPages> pinned = GetPinnedPages();
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+
+  // a page only changes its type when it is freed and reused, which needs a write latch on its parent (or on
+  // root_latch_ for the root), so the type can be read before deciding which latch to take
+  Page *page = FetchPage(root_page_id_, pinned.get());
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!node->IsLeafPage()) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+    Page *child_page = FetchPage(child_page_id, pinned.get());
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (child->IsLeafPage()) {
+      child_page->WLatch();
+    } else {
+      child_page->RLatch();
+    }
+    page->RUnlatch();
+    UnpinPage(page, pinned.get());
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op, int count) {
+  if (op == Operation::INSERT) {
+    // a leaf splits when it reaches max size, an internal page when it goes beyond
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() : node->GetSize() < node->GetMaxSize();
+  }
+  if (op == Operation::DELETE) {
+    if (node->IsRootPage()) {
+      // the root changes when the last key is gone or a single child is left
+      return node->IsLeafPage() ? node->GetSize() > count : node->GetSize() > 2;
+    }
+    return node->GetSize() - count >= MinSize(node);
+  }
+  if (op == Operation::COMPACT) {
+    // the leaf is about to be merged, its parent then loses an entry
+    return !node->IsLeafPage() && !node->IsRootPage() && node->GetSize() - 1 >= MinSize(node);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MinSize(BPlusTreePage *node) const {
+  // a leaf keeps at least one pair and an internal page two children, whatever the threshold
+  if (node->IsLeafPage()) {
+    return std::max(1, static_cast<int>(node->GetMaxSize() * merge_threshold_));
+  }
+  return std::max(2, static_cast<int>(std::ceil(node->GetMaxSize() * merge_threshold_)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPages(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  while (!page_set->empty()) {
+    Page *page = page_set->front();
+    page_set->pop_front();
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Transaction *transaction) {
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    FreePage(page_id);
+  }
+  deleted_page_set->clear();
+  // the readers that pinned the pages freed by earlier operations have likely moved on by now
+  freed_pages_.Retry(buffer_pool_manager_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreePage(page_id_t page_id) {
+  // a snapshot, not necessarily the current one, may still pin the page for the lookups that took it. The latch keeps
+  // a snapshot from retrying the deletes between a failed delete and its page joining them
+  std::lock_guard<std::mutex> guard(freed_pages_.latch_);
+  if (!buffer_pool_manager_->DeletePage(page_id)) {
+    freed_pages_.page_ids_.push_back(page_id);
+    pinned_pages_stale_ = true;
+  }
+}
+
+/*****************************************************************************
+ * PINNED TOP LEVELS
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::PinnedPages::~PinnedPages() {
+  for (const auto &[page_id, page] : pages_) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  // those still pinned by another snapshot are deleted along with it
+  freed_->Retry(buffer_pool_manager_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreedPages::Retry(BufferPoolManager *buffer_pool_manager) {
+  std::lock_guard<std::mutex> guard(latch_);
+  page_ids_.erase(std::remove_if(page_ids_.begin(), page_ids_.end(),
+                                 [buffer_pool_manager](page_id_t page_id) {
+                                   return buffer_pool_manager->DeletePage(page_id);
+                                 }),
+                  page_ids_.end());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PinTopLevels(int levels) {
+  BUSTUB_ASSERT(levels >= 0 && (levels == 0 || !b_link_), "Top levels are not pinned in B-link mode");
+  pinned_levels_ = levels;
+  pinned_pages_stale_ = false;
+  RefreshPinnedPages();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetPinnedPages() -> std::shared_ptr<PinnedPages> {
+  if (pinned_levels_ == 0) {
+    return nullptr;
+  }
+  if (pinned_pages_stale_.exchange(false)) {
+    RefreshPinnedPages();
+  }
+  return std::atomic_load(&pinned_pages_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RefreshPinnedPages() {
+  int levels = pinned_levels_;
+  if (levels == 0) {
+    std::atomic_store(&pinned_pages_, std::shared_ptr<PinnedPages>());
+    return;
+  }
+  auto pinned = std::make_shared<PinnedPages>(buffer_pool_manager_, &freed_pages_);
+  // the rest of the pool is left to the leaves and to the pages below the pinned levels
+  size_t max_pages = buffer_pool_manager_->GetPoolSize() / 4;
+
+  root_latch_.RLock();
+  Page *root = IsEmpty() || max_pages == 0 ? nullptr : buffer_pool_manager_->FetchPage(root_page_id_);
+  if (root == nullptr) {
+    root_latch_.RUnlock();
+    std::atomic_store(&pinned_pages_, pinned);
+    return;
+  }
+  root->RLatch();
+  root_latch_.RUnlock();
+  std::vector<Page *> level;
+  if (reinterpret_cast<BPlusTreePage *>(root->GetData())->IsLeafPage()) {
+    root->RUnlatch();
+    buffer_pool_manager_->UnpinPage(root->GetPageId(), false);
+  } else {
+    pinned->pages_.emplace(root->GetPageId(), root);
+    level.push_back(root);
+    root->RUnlatch();
+  }
+
+  // children are pinned under the read latch of their parent, which keeps them from being freed meanwhile
+  for (int depth = 1; depth < levels && !level.empty(); depth++) {
+    std::vector<Page *> next_level;
+    for (Page *page : level) {
+      page->RLatch();
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      for (int i = 0; i < internal->GetSize() && pinned->pages_.size() < max_pages; i++) {
+        Page *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(i));
+        if (child_page == nullptr) {
+          break;
+        }
+        if (reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage() ||
+            !pinned->pages_.emplace(child_page->GetPageId(), child_page).second) {
+          buffer_pool_manager_->UnpinPage(child_page->GetPageId(), false);
+          continue;
+        }
+        next_level.push_back(child_page);
+      }
+      page->RUnlatch();
+    }
+    level = std::move(next_level);
+  }
+  std::atomic_store(&pinned_pages_, pinned);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchPage(page_id_t page_id, const PinnedPages *pinned) {
+  if (pinned != nullptr) {
+    Page *page = pinned->Find(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return buffer_pool_manager_->FetchPage(page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UnpinPage(Page *page, const PinnedPages *pinned) {
+  if (pinned == nullptr || pinned->Find(page->GetPageId()) != page) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*****************************************************************************
+ * B-LINK MODE
+ *****************************************************************************/
+/*
+ * Insert into a B-link tree. The leaf is found without latching anything above it; if it has to split, the separator
+ * is inserted into the parents recorded on the way down, moving right where they have split in the meantime.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) {
+  std::vector<page_id_t> path;
+  Page *page = FindLeafPageBLink(key, Operation::INSERT, &path);
+  if (page == nullptr) {
+    root_latch_.WLock();
+    if (IsEmpty()) {
+      StartNewTree(key, value);
+      root_latch_.WUnlock();
+      return true;
+    }
+    // another insertion started the tree first
+    root_latch_.WUnlock();
+    return InsertBLink(key, value);
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+
+  if (InsertIntoPage(leaf, key, value, false) == LeafChange::NONE) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (leaf->GetSize() < leaf->GetMaxSize()) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+
+  // the new leaf is reachable through the right link as soon as the split leaf is unlatched
+  LeafPage *new_leaf = Split(leaf);
+  KeyType separator = new_leaf->KeyAt(0);
+  page_id_t new_page_id = new_leaf->GetPageId();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  InsertIntoParentBLink(page, separator, new_page_id, &path);
+  return true;
+}
+
+/*
+ * Insert the separator key and the new right sibling of the write latched page into its parent, splitting upwards as
+ * long as needed. The page stays latched until its parent is, so that its separators reach the parent in the order
+ * of its splits; at most the page, its parent and the parent's right sibling are latched at any time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(Page *page, KeyType key, page_id_t new_page_id,
+                                           std::vector<page_id_t> *path) {
+  while (true) {
+    page_id_t old_page_id = page->GetPageId();
+    page_id_t parent_page_id;
+    if (path->empty()) {
+      // the page was the root when we came down, it still is unless another split added a level above it
+      root_latch_.WLock();
+      if (root_page_id_ == old_page_id) {
+        page_id_t root_page_id;
+        Page *root_page = buffer_pool_manager_->NewPage(&root_page_id);
+        if (root_page == nullptr) {
+          root_latch_.WUnlock();
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+        }
+        auto *root = reinterpret_cast<InternalPage *>(root_page->GetData());
+        root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, compress_);
+        root->PopulateNewRoot(old_page_id, key, new_page_id);
+        root_page_id_ = root_page_id;
+        UpdateRootPageId(0);
+        root_latch_.WUnlock();
+        buffer_pool_manager_->UnpinPage(root_page_id, true);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(old_page_id, true);
+        return;
+      }
+      root_latch_.WUnlock();
+      parent_page_id = FindParentBLink(old_page_id, key);
+    } else {
+      parent_page_id = path->back();
+      path->pop_back();
+    }
+
+    Page *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
+    if (parent_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch parent page");
+    }
+    parent_page->WLatch();
+    parent_page = MoveRight(parent_page, key, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(old_page_id, true);
+
+    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    if (parent->InsertNodeAfter(old_page_id, key, new_page_id) <= parent->GetMaxSize()) {
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      return;
+    }
+    InternalPage *new_parent = Split(parent);
+    key = new_parent->KeyAt(0);
+    new_page_id = new_parent->GetPageId();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    page = parent_page;
+  }
+}
+
+/*
+ * Remove from a B-link tree. Pages are never merged in this mode, a leaf simply shrinks, possibly down to nothing.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key, const ValueType *value) {
+  Page *page = FindLeafPageBLink(key, Operation::DELETE);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool removed = RemoveFromPage(leaf, key, value, false) == LeafChange::DONE;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBLink(const KeyType &key, Operation op, std::vector<page_id_t> *path,
+                                        bool left_most) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  page_id_t page_id = root_page_id_;
+  root_latch_.RUnlock();
+
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page");
+    }
+    // pages are never freed in this mode, so a page keeps the type it was created with
+    bool exclusive = op != Operation::READ && reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage();
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    // the leftmost page of a level stays the leftmost one, it never has to move right
+    if (!left_most) {
+      page = MoveRight(page, key, exclusive);
+    }
+
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+    page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType &key, bool exclusive, bool before, bool right_most) {
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id;
+    KeyType high_key;
+    if (node->IsLeafPage()) {
+      next_page_id = reinterpret_cast<LeafPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<LeafPage *>(node)->GetHighKey();
+    } else {
+      next_page_id = reinterpret_cast<InternalPage *>(node)->GetNextPageId();
+      high_key = reinterpret_cast<InternalPage *>(node)->GetHighKey();
+    }
+    // looking for the keys before key, a page whose high key is key already holds them
+    bool holds_key = before ? comparator_(high_key, key) >= 0 : comparator_(key, high_key) < 0;
+    if (next_page_id == INVALID_PAGE_ID || (!right_most && holds_key)) {
+      return page;
+    }
+
+    // latches are only ever taken from left to right on a level, coupling them cannot deadlock
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch right sibling page");
+    }
+    if (exclusive) {
+      next_page->WLatch();
+      page->WUnlatch();
+    } else {
+      next_page->RLatch();
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::FindParentBLink(page_id_t child_page_id, const KeyType &key) {
+  root_latch_.RLock();
+  page_id_t page_id = root_page_id_;
+  root_latch_.RUnlock();
+
+  // whoever split the child off its left sibling posted it to the parent level before we could latch the child
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch page");
+    }
+    page->RLatch();
+    page = MoveRight(page, key, false);
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    BUSTUB_ASSERT(!internal->IsLeafPage(), "the parent of a page is above the leaves");
+    page_id = page->GetPageId();
+    bool found = internal->ValueIndex(child_page_id) != -1;
+    page_id_t child = internal->Lookup(key, comparator_);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (found) {
+      return page_id;
+    }
+    page_id = child;
+  }
 }
 
 /*
@@ -225,10 +1984,16 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
+  pinned_pages_stale_ = true;
+  if (!persist_root_) {
+    return;
+  }
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
   if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+    // create a new record<index_name + root_page_id> in header_page, a tree that was emptied before already has one
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
   } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
@@ -399,4 +2164,16 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTree<GenericKey<4>, CoveringValue<4>, GenericComparator<4>>;
+template class BPlusTree<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>;
+template class BPlusTree<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class BPlusTree<GenericKey<32>, CoveringValue<32>, GenericComparator<32>>;
+template class BPlusTree<GenericKey<64>, CoveringValue<64>, GenericComparator<64>>;
+
 }  // namespace bustub
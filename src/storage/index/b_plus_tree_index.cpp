@@ -9,9 +9,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <type_traits>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
+
 /*
  * Constructor
  */
@@ -19,33 +26,195 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE, false,
+                 false, metadata->IsUnique()) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_.Insert(index_key, rid, transaction);
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    container_.Insert(index_key, rid, transaction);
+  } else {
+    // an entry without its included columns would hand index-only scans a zeroed payload
+    throw Exception(ExceptionType::MISMATCH_TYPE, "The included columns are missing");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, const Tuple &included, RID rid, Transaction *transaction) {
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    InsertEntry(key, rid, transaction);
+  } else {
+    KeyType index_key;
+    index_key.SetFromKey(key, *GetKeySchema());
+    ValueType value(rid);
+    value.SetFromTuple(included);
+    CountModification();
+    container_.Insert(index_key, value, transaction);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_.Remove(index_key, transaction);
+  // a non-unique key keeps its other tuples
+  if (GetMetadata()->IsUnique()) {
+    container_.Remove(index_key, transaction);
+  } else {
+    container_.Remove(index_key, rid, transaction);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
+
+  if constexpr (std::is_same_v<ValueType, RID>) {
+    container_.GetValue(index_key, result, transaction);
+  } else {
+    std::vector<ValueType> values;
+    container_.GetValue(index_key, &values, transaction);
+    result->insert(result->end(), values.begin(), values.end());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low, const Tuple *high,
+                                     const std::function<bool(const Tuple &, RID)> &callback,
+                                     Transaction *transaction) {
+  if constexpr (!HasToValue<KeyType>::value || std::is_same_v<ValueType, RID>) {
+    // normalized keys cannot be decoded, and without included columns there is nothing to cover a query with
+    throw NotImplementedException("Index-only scans need decodable keys and included columns");
+  } else {
+    Schema *key_schema = GetKeySchema();
+    Schema *include_schema = GetMetadata()->GetIncludeSchema();
+    KeyType low_key;
+    KeyType high_key;
+    if (low != nullptr) {
+      low_key.SetFromKey(*low, *key_schema);
+    }
+    if (high != nullptr) {
+      high_key.SetFromKey(*high, *key_schema);
+    }
+    std::vector<Value> values;
+    for (auto it = low != nullptr ? container_.Begin(low_key) : container_.begin(); !it.isEnd(); ++it) {
+      const auto &[key, value] = *it;
+      if (high != nullptr && comparator_(key, high_key) >= 0) {
+        break;
+      }
+      values.clear();
+      for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+        values.push_back(key.ToValue(key_schema, i));
+      }
+      for (uint32_t i = 0; i < include_schema->GetColumnCount(); i++) {
+        values.push_back(value.ToValue(include_schema, i));
+      }
+      if (!callback(Tuple(values, GetMetadata()->GetCoveredSchema()), value.GetRid())) {
+        break;
+      }
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], *GetKeySchema());
+  }
+  // probe in key order, then hand the values back in the order of the keys
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return comparator_(index_keys[lhs], index_keys[rhs]) < 0; });
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (auto i : order) {
+    sorted_keys.push_back(index_keys[i]);
+  }
+  std::vector<std::vector<ValueType>> sorted_results;
+  container_.GetValues(sorted_keys, &sorted_results, transaction);
+  results->resize(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    auto &result = (*results)[order[i]];
+    result.insert(result.end(), sorted_results[i].begin(), sorted_results[i].end());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+IndexStatistics BPLUSTREE_INDEX_TYPE::CollectStatistics(Transaction *transaction) {
+  IndexStatisticsCollector collector;
+  std::function<Value(const KeyType &)> first_column;
+  if constexpr (HasToValue<KeyType>::value) {
+    first_column = [this](const KeyType &key) { return key.ToValue(GetKeySchema(), 0); };
+  }
+  container_.CollectStatistics(&collector, first_column);
+  return collector.Finish();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries, double fill_factor) {
+  auto entry = entries.begin();
+  auto next = [&](KeyType *key, ValueType *value) {
+    if (entry == entries.end()) {
+      return false;
+    }
+    *key = entry->first;
+    *value = entry->second;
+    ++entry;
+    return true;
+  };
+  return container_.BulkLoad(next, fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::vector<std::vector<std::pair<KeyType, ValueType>>> &runs,
+                                    double fill_factor) {
+  // a min-heap of the runs that are not exhausted, by their next pair; of equal keys the pair of the earlier run comes
+  // first, or the pair with the smaller record id if keys are not unique
+  bool unique = GetMetadata()->IsUnique();
+  std::vector<size_t> positions(runs.size(), 0);
+  auto after = [&](size_t a, size_t b) {
+    const auto &[a_key, a_value] = runs[a][positions[a]];
+    const auto &[b_key, b_value] = runs[b][positions[b]];
+    int order = comparator_(a_key, b_key);
+    if (order == 0 && !unique && RID(a_value).Get() != RID(b_value).Get()) {
+      return RID(a_value).Get() > RID(b_value).Get();
+    }
+    return order > 0 || (order == 0 && a > b);
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(after)> heap(after);
+  for (size_t i = 0; i < runs.size(); i++) {
+    if (!runs[i].empty()) {
+      heap.push(i);
+    }
+  }
 
-  container_.GetValue(index_key, result, transaction);
+  auto next = [&](KeyType *key, ValueType *value) {
+    if (heap.empty()) {
+      return false;
+    }
+    size_t run = heap.top();
+    heap.pop();
+    *key = runs[run][positions[run]].first;
+    *value = runs[run][positions[run]].second;
+    if (++positions[run] < runs[run].size()) {
+      heap.push(run);
+    }
+    return true;
+  };
+  return container_.BulkLoad(next, fill_factor);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -57,10 +226,30 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.rbegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const KeyType &low, const KeyType &high, bool reverse) {
+  return container_.Range(low, high, reverse);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTreeIndex<GenericKey<4>, CoveringValue<4>, GenericComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>;
+template class BPlusTreeIndex<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class BPlusTreeIndex<GenericKey<32>, CoveringValue<32>, GenericComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, CoveringValue<64>, GenericComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,76 @@
+#include <functional>
+#include <vector>
+
+#include "common/exception.h"
+#include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(IndexMetadata *metadata,
+                                                           BufferPoolManager *buffer_pool_manager,
+                                                           const HashFunction<KeyType> &hash_fn)
+    : Index(metadata),
+      comparator_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key, *GetKeySchema());
+
+  // the table chains overflow buckets rather than run out of room, it only turns down a pair it holds already
+  if (!container_.Insert(transaction, index_key, rid)) {
+    throw Exception(ExceptionType::INVALID, "The index holds the entry already");
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key, *GetKeySchema());
+
+  container_.Remove(transaction, index_key, rid);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key, *GetKeySchema());
+
+  container_.GetValue(transaction, index_key, result);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+IndexStatistics EXTENDIBLE_HASH_TABLE_INDEX_TYPE::CollectStatistics(Transaction *transaction) {
+  IndexStatisticsCollector collector;
+  std::function<Value(const KeyType &)> first_column;
+  if constexpr (HasToValue<KeyType>::value) {
+    first_column = [this](const KeyType &key) { return key.ToValue(GetKeySchema(), 0); };
+  }
+  container_.CollectStatistics(&collector, first_column);
+  return collector.Finish();
+}
+
+template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ExtendibleHashTableIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class ExtendibleHashTableIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class ExtendibleHashTableIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExtendibleHashTableIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExtendibleHashTableIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
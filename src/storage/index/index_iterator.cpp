@@ -2,29 +2,257 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, std::shared_ptr<void> generation, Page *page, int index, bool reverse,
+                                  bool left_most, const KeyType *bound)
+    : tree_(tree),
+      generation_(std::move(generation)),
+      buffer_pool_manager_(tree->buffer_pool_manager_),
+      page_(page),
+      index_(index),
+      postings_(!tree->unique_),
+      reverse_(reverse),
+      left_most_(left_most),
+      bounded_(bound != nullptr) {
+  if (bounded_) {
+    bound_ = *bound;
+  }
+  if (page_ != nullptr) {
+    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    if (reverse_) {
+      SkipExhaustedLeavesBackward();
+    } else {
+      SkipExhaustedLeaves();
+    }
+    CheckBound();
+    EnterPostingList();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept {
+  *this = std::move(other);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    tree_ = other.tree_;
+    generation_ = std::move(other.generation_);
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    postings_ = other.postings_;
+    reverse_ = other.reverse_;
+    left_most_ = other.left_most_;
+    bounded_ = other.bounded_;
+    bound_ = other.bound_;
+    posting_page_id_ = other.posting_page_id_;
+    posting_ = other.posting_;
+    posting_index_ = other.posting_index_;
+    posting_values_ = std::move(other.posting_values_);
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+    other.posting_page_id_ = INVALID_PAGE_ID;
+    other.posting_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::isEnd() { return page_ == nullptr; }
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { throw std::runtime_error("unimplemented"); }
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(page_ != nullptr);
+  item_ = leaf_->GetItem(index_);
+  if (posting_ != nullptr) {
+    item_.second = posting_->ValueAt(posting_index_);
+  } else if (!posting_values_.empty()) {
+    item_.second = posting_values_[posting_index_];
+  }
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  if (reverse_) {
+    if (!posting_values_.empty()) {
+      if (--posting_index_ >= 0) {
+        return *this;
+      }
+      posting_values_.clear();
+    }
+    index_--;
+    SkipExhaustedLeavesBackward();
+    CheckBound();
+    EnterPostingList();
+    return *this;
+  }
+
+  if (posting_ != nullptr) {
+    if (++posting_index_ < posting_->GetSize()) {
+      return *this;
+    }
+    page_id_t next_page_id = posting_->GetNextPageId();
+    ReleasePostingPage();
+    if (next_page_id != INVALID_PAGE_ID) {
+      posting_page_id_ = next_page_id;
+      posting_ = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(next_page_id)->GetData());
+      return *this;
+    }
+  }
+  index_++;
+  SkipExhaustedLeaves();
+  CheckBound();
+  EnterPostingList();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int INDEXITERATOR_TYPE::NextBatch(std::vector<MappingType> *batch, int max_count) {
+  if (page_ == nullptr) {
+    return 0;
+  }
+  page_id_t page_id = page_->GetPageId();
+  int count = 0;
+  while (count < max_count && page_ != nullptr && page_->GetPageId() == page_id) {
+    batch->push_back(**this);
+    count++;
+    ++(*this);
+  }
+  return count;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      Release();
+      return;
+    }
+    // every key below the high key of this leaf was returned, the pairs left start there
+    KeyType boundary = leaf_->GetHighKey();
+    // pin the next leaf before letting go of this one, but never wait for a latch while holding one: writers latch
+    // siblings from right to left when they merge
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    Release();
+    if (next_page == nullptr) {
+      return;
+    }
+    next_page->RLatch();
+
+    // as in BPlusTree::MoveToNextLeaf, the next leaf may meanwhile have traded keys with this one, or have been merged
+    // into it and left empty
+    auto *next = reinterpret_cast<LeafPage *>(next_page->GetData());
+    const KeyComparator &comparator = tree_->comparator_;
+    bool holds_boundary = (tree_->b_link_ || next->GetSize() > 0) && comparator(next->GetLowKey(), boundary) <= 0 &&
+                          (next->GetNextPageId() == INVALID_PAGE_ID || comparator(boundary, next->GetHighKey()) < 0);
+    if (holds_boundary) {
+      page_ = next_page;
+    } else {
+      next_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      page_ = tree_->FindLeafPage(boundary);
+      if (page_ == nullptr) {
+        return;
+      }
+    }
+    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    index_ = leaf_->KeyIndex(boundary, comparator);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipExhaustedLeavesBackward() {
+  while (page_ != nullptr && index_ < 0) {
+    if (left_most_) {
+      Release();
+      return;
+    }
+    // the pairs left of this leaf are those with keys below its low key, wherever they are once it is let go of
+    KeyType boundary = leaf_->GetLowKey();
+    Release();
+    page_ = tree_->FindLeafPageBefore(boundary, false, &left_most_);
+    if (page_ != nullptr) {
+      leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+      index_ = leaf_->KeyIndex(boundary, tree_->comparator_) - 1;
+    }
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::CheckBound() {
+  if (page_ == nullptr || !bounded_) {
+    return;
+  }
+  int order = tree_->comparator_(leaf_->KeyAt(index_), bound_);
+  if (reverse_ ? order < 0 : order >= 0) {
+    Release();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterPostingList() {
+  page_id_t page_id;
+  if (!postings_ || page_ == nullptr || !BPlusTreePostingPage::IsReference(leaf_->ValueAt(index_), &page_id)) {
+    return;
+  }
+  // the posting pages are only modified under the write latch of the leaf, which is read latched here
+  if (!reverse_) {
+    posting_page_id_ = page_id;
+    posting_ = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    return;
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    for (int i = 0; i < posting->GetSize(); i++) {
+      posting_values_.push_back(posting->ValueAt(i));
+    }
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  posting_index_ = static_cast<int>(posting_values_.size()) - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReleasePostingPage() {
+  if (posting_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(posting_page_id_, false);
+    posting_page_id_ = INVALID_PAGE_ID;
+    posting_ = nullptr;
+  }
+  posting_values_.clear();
+  posting_index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  ReleasePostingPage();
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+    leaf_ = nullptr;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +264,24 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class IndexIterator<GenericKey<4>, CoveringValue<4>, GenericComparator<4>>;
+
+template class IndexIterator<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>;
+
+template class IndexIterator<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<32>, CoveringValue<32>, GenericComparator<32>>;
+
+template class IndexIterator<GenericKey<64>, CoveringValue<64>, GenericComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_statistics.cpp
+//
+// Identification: src/storage/index/index_statistics.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cmath>
+
+#include "common/macros.h"
+#include "storage/index/index_statistics.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HYPERLOGLOG
+ *****************************************************************************/
+HyperLogLog::HyperLogLog(uint32_t precision) : precision_(precision), registers_(1U << precision, 0) {
+  BUSTUB_ASSERT(precision >= 4 && precision <= 16, "Precision out of range");
+}
+
+void HyperLogLog::Add(uint64_t hash) {
+  uint64_t rest = hash << precision_;
+  auto rank = static_cast<uint8_t>(rest == 0 ? 64 - precision_ + 1 : __builtin_clzll(rest) + 1);
+  uint8_t &reg = registers_[hash >> (64 - precision_)];
+  reg = std::max(reg, rank);
+}
+
+void HyperLogLog::Merge(const HyperLogLog &other) {
+  BUSTUB_ASSERT(precision_ == other.precision_, "Sketches of different precision");
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+  auto m = static_cast<double>(registers_.size());
+  double sum = 0;
+  size_t zeros = 0;
+  for (uint8_t reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    zeros += reg == 0 ? 1 : 0;
+  }
+  double alpha = m >= 128 ? 0.7213 / (1 + 1.079 / m) : m >= 64 ? 0.709 : m >= 32 ? 0.697 : 0.673;
+  double estimate = alpha * m * m / sum;
+  // the raw estimate is biased upwards for small counts, which leave registers empty; count those instead
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return static_cast<uint64_t>(std::llround(estimate));
+}
+
+/*****************************************************************************
+ * STATISTICS
+ *****************************************************************************/
+double IndexStatistics::EstimateRangeFraction(const Value &low, const Value &high) const {
+  if (histogram_bounds_.empty()) {
+    // the guess of System R for a range without any statistics
+    return 1.0 / 3;
+  }
+  return std::max(0.0, FractionBelow(high) - FractionBelow(low));
+}
+
+double IndexStatistics::FractionBelow(const Value &value) const {
+  // the first bound above value ends the bucket value falls into
+  auto above =
+      std::upper_bound(histogram_bounds_.begin(), histogram_bounds_.end(), value, [](const Value &v, const Value &b) {
+        return v.CompareLessThan(b) == CmpBool::CmpTrue;
+      });
+  if (above == histogram_bounds_.begin()) {
+    return 0;
+  }
+  if (above == histogram_bounds_.end()) {
+    return 1;
+  }
+  const Value &lower = *(above - 1);
+  double within = 0.5;
+  TypeId type = value.GetTypeId();
+  if (type >= TypeId::TINYINT && type <= TypeId::DECIMAL && lower.GetTypeId() == type) {
+    double from = lower.CastAs(TypeId::DECIMAL).GetAs<double>();
+    double to = above->CastAs(TypeId::DECIMAL).GetAs<double>();
+    if (to > from) {
+      within = (value.CastAs(TypeId::DECIMAL).GetAs<double>() - from) / (to - from);
+    }
+  }
+  auto num_buckets = static_cast<double>(histogram_bounds_.size() - 1);
+  return (static_cast<double>(above - histogram_bounds_.begin() - 1) + within) / num_buckets;
+}
+
+/*****************************************************************************
+ * COLLECTOR
+ *****************************************************************************/
+IndexStatisticsCollector::IndexStatisticsCollector(size_t num_buckets, size_t sample_size)
+    : num_buckets_(num_buckets), sample_size_(sample_size) {
+  BUSTUB_ASSERT(num_buckets > 0 && sample_size > num_buckets, "Histogram needs more samples than buckets");
+  sample_.reserve(sample_size);
+}
+
+void IndexStatisticsCollector::AddPage(size_t used, size_t capacity) {
+  statistics_.num_pages_++;
+  used_slots_ += capacity == 0 ? 0 : static_cast<double>(used) / capacity;
+}
+
+void IndexStatisticsCollector::AddKey(uint64_t hash, const Value *first_column, uint64_t count) {
+  distinct_keys_.Add(hash);
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t seen = ++statistics_.num_entries_;
+    if (first_column == nullptr) {
+      continue;
+    }
+    if (extremes_.empty()) {
+      extremes_ = {*first_column, *first_column};
+    } else if (first_column->CompareLessThan(extremes_[0]) == CmpBool::CmpTrue) {
+      extremes_[0] = *first_column;
+    } else if (first_column->CompareGreaterThan(extremes_[1]) == CmpBool::CmpTrue) {
+      extremes_[1] = *first_column;
+    }
+    // every entry seen so far stays in the sample with the same probability
+    if (sample_.size() < sample_size_) {
+      sample_.push_back(*first_column);
+    } else if (uint64_t slot = rng_() % seen; slot < sample_size_) {
+      sample_[slot] = *first_column;
+    }
+  }
+}
+
+IndexStatistics IndexStatisticsCollector::Finish() {
+  if (statistics_.num_pages_ > 0) {
+    statistics_.fill_factor_ = used_slots_ / static_cast<double>(statistics_.num_pages_);
+  }
+  statistics_.distinct_keys_ = std::min(distinct_keys_.Estimate(), statistics_.num_entries_);
+
+  statistics_.histogram_bounds_.clear();
+  if (!sample_.empty()) {
+    std::sort(sample_.begin(), sample_.end(),
+              [](const Value &a, const Value &b) { return a.CompareLessThan(b) == CmpBool::CmpTrue; });
+    size_t num_buckets = std::max<size_t>(std::min(num_buckets_, sample_.size() - 1), 1);
+    for (size_t i = 0; i <= num_buckets; i++) {
+      statistics_.histogram_bounds_.push_back(sample_[i * (sample_.size() - 1) / num_buckets]);
+    }
+    // the sample may have missed the ends
+    statistics_.histogram_bounds_.front() = extremes_[0];
+    statistics_.histogram_bounds_.back() = extremes_[1];
+  }
+  return statistics_;
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <functional>
 #include <vector>
 
 #include "storage/index/linear_probe_hash_table_index.h"
@@ -15,18 +16,20 @@ HASH_TABLE_INDEX_TYPE::LinearProbeHashTableIndex(IndexMetadata *metadata, Buffer
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Insert(transaction, index_key, rid);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -35,14 +38,32 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+IndexStatistics HASH_TABLE_INDEX_TYPE::CollectStatistics(Transaction *transaction) {
+  IndexStatisticsCollector collector;
+  std::function<Value(const KeyType &)> first_column;
+  if constexpr (HasToValue<KeyType>::value) {
+    first_column = [this](const KeyType &key) { return key.ToValue(GetKeySchema(), 0); };
+  }
+  container_.CollectStatistics(&collector, first_column);
+  return collector.Finish();
+}
+
 template class LinearProbeHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class LinearProbeHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class LinearProbeHashTableIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class LinearProbeHashTableIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class LinearProbeHashTableIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class LinearProbeHashTableIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class LinearProbeHashTableIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,428 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/var_length_b_plus_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/index/var_length_b_plus_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+VarLengthBPlusTree::VarLengthBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, bool unique)
+    : index_name_(std::move(name)),
+      root_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      unique_(unique) {}
+
+bool VarLengthBPlusTree::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+size_t VarLengthBPlusTree::MaxKeySize() const { return LeafPage::MaxKeySize() - (unique_ ? 0 : sizeof(RID)); }
+
+std::string VarLengthBPlusTree::MakeKey(std::string_view key, const RID &value) const {
+  std::string result(key);
+  if (!unique_) {
+    for (uint32_t part : {static_cast<uint32_t>(value.GetPageId()), value.GetSlotNum()}) {
+      for (int shift = 24; shift >= 0; shift -= 8) {
+        result.push_back(static_cast<char>(part >> shift));
+      }
+    }
+  }
+  return result;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the values that are associated with input key, a single one if keys are unique
+ * @return : true means key exists
+ */
+bool VarLengthBPlusTree::GetValue(std::string_view key, std::vector<RID> *result, Transaction *transaction) {
+  Page *page = FindLeafPage(key, false);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  if (unique_) {
+    bool found = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+    if (found) {
+      result->push_back(leaf->ValueAt(index));
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return found;
+  }
+
+  // the pairs of the key start with it, but so may longer keys, whose pairs are skipped
+  bool found = false;
+  while (true) {
+    for (; index < leaf->GetSize() && leaf->KeyAt(index).substr(0, key.size()) == key; index++) {
+      if (leaf->KeyAt(index).size() == key.size() + sizeof(RID)) {
+        result->push_back(leaf->ValueAt(index));
+        found = true;
+      }
+    }
+    if (index < leaf->GetSize()) {
+      break;
+    }
+    page = MoveToNextLeaf(page, false);
+    if (page == nullptr) {
+      return found;
+    }
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    index = 0;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into b+ tree
+ * @return: if user try to insert a duplicate key, or a duplicate pair if keys are
+ * not unique, return false, otherwise return true.
+ */
+bool VarLengthBPlusTree::Insert(std::string_view key, const RID &value, Transaction *transaction) {
+  if (key.size() > MaxKeySize()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Key too long for the index");
+  }
+  std::string entry_key = MakeKey(key, value);
+
+  // most insertions fit into the leaf, try them with only the leaf write latched first
+  Page *page = FindLeafPage(entry_key, true);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(entry_key);
+    bool duplicate = index < leaf->GetSize() && leaf->KeyAt(index) == entry_key;
+    bool fits = !duplicate && leaf->HasRoom(entry_key.size());
+    if (fits) {
+      leaf->InsertAt(index, entry_key, value);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), fits);
+    if (duplicate || fits) {
+      return fits;
+    }
+  }
+
+  // the tree is empty or the leaf has to split, restart and crab down with write latches
+  root_latch_.WLock();
+  if (IsEmpty()) {
+    page_id_t root_page_id;
+    auto *root = reinterpret_cast<LeafPage *>(NewPage(&root_page_id)->GetData());
+    root->Init(root_page_id);
+    root->InsertAt(0, entry_key, value);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(1);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    root_latch_.WUnlock();
+    return true;
+  }
+  root_latch_.WUnlock();
+
+  // crabbing keeps its latched pages in a transaction, borrow one if the caller has none
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    return InsertIntoLeaf(entry_key, value, &local_transaction);
+  }
+  return InsertIntoLeaf(entry_key, value, transaction);
+}
+
+bool VarLengthBPlusTree::InsertIntoLeaf(std::string_view key, const RID &value, Transaction *transaction) {
+  // pages are never merged, a tree that had a root keeps one
+  Page *page = FindLeafPageForInsert(key, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  if (index < leaf->GetSize() && leaf->KeyAt(index) == key) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+
+  if (leaf->HasRoom(key.size())) {
+    leaf->InsertAt(index, key, value);
+    ReleaseLatchedPages(transaction, true);
+    return true;
+  }
+
+  // nobody can reach the new leaf before the old one is released, so it is not latched
+  page_id_t new_page_id;
+  auto *new_leaf = reinterpret_cast<LeafPage *>(NewPage(&new_page_id)->GetData());
+  new_leaf->Init(new_page_id);
+  std::string separator = leaf->MoveHalfTo(new_leaf);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  leaf->SetNextPageId(new_page_id);
+  LeafPage *target = key < separator ? leaf : new_leaf;
+  target->InsertAt(target->KeyIndex(key), key, value);
+
+  InsertIntoParent(transaction, transaction->GetPageSet()->size() - 1, separator, new_page_id);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  ReleaseLatchedPages(transaction, true);
+  return true;
+}
+
+void VarLengthBPlusTree::InsertIntoParent(Transaction *transaction, size_t index, const std::string &key,
+                                          page_id_t new_page_id) {
+  auto page_set = transaction->GetPageSet();
+  page_id_t old_page_id = (*page_set)[index]->GetPageId();
+  Page *parent_page = (*page_set)[index - 1];
+  if (parent_page == nullptr) {
+    // the root split, root_latch_ is still held
+    page_id_t root_page_id;
+    auto *root = reinterpret_cast<InternalPage *>(NewPage(&root_page_id)->GetData());
+    root->Init(root_page_id);
+    root->InsertAt(0, std::string_view(), old_page_id);
+    root->InsertAt(1, key, new_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (parent->HasRoom(key.size())) {
+    parent->InsertAt(parent->ValueIndex(old_page_id) + 1, key, new_page_id);
+    return;
+  }
+
+  page_id_t new_parent_page_id;
+  auto *new_parent = reinterpret_cast<InternalPage *>(NewPage(&new_parent_page_id)->GetData());
+  new_parent->Init(new_parent_page_id);
+  std::string separator = parent->MoveHalfTo(new_parent);
+  InternalPage *target = parent;
+  if (parent->ValueIndex(old_page_id) == parent->GetSize()) {
+    target = new_parent;
+  }
+  target->InsertAt(target->ValueIndex(old_page_id) + 1, key, new_page_id);
+  InsertIntoParent(transaction, index - 1, separator, new_parent_page_id);
+  buffer_pool_manager_->UnpinPage(new_parent_page_id, true);
+}
+
+Page *VarLengthBPlusTree::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete key & all of its values from the tree. Leaves are never merged, so only the leaves that hold the key are
+ * latched, one after another.
+ */
+void VarLengthBPlusTree::Remove(std::string_view key, Transaction *transaction) { RemoveEntry(key, nullptr); }
+
+/*
+ * Delete only the pair with the given value, if keys are not unique.
+ */
+void VarLengthBPlusTree::Remove(std::string_view key, const RID &value, Transaction *transaction) {
+  RemoveEntry(key, &value);
+}
+
+void VarLengthBPlusTree::RemoveEntry(std::string_view key, const RID *value) {
+  if (key.size() > MaxKeySize()) {
+    return;
+  }
+  std::string entry_key = value != nullptr ? MakeKey(key, *value) : std::string(key);
+  Page *page = FindLeafPage(entry_key, true);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(entry_key);
+  bool is_dirty = false;
+  if (unique_ || value != nullptr) {
+    if (index < leaf->GetSize() && leaf->KeyAt(index) == entry_key &&
+        (value == nullptr || leaf->ValueAt(index) == *value)) {
+      leaf->RemoveAt(index);
+      is_dirty = true;
+    }
+  } else {
+    while (true) {
+      while (index < leaf->GetSize() && leaf->KeyAt(index).substr(0, key.size()) == key) {
+        if (leaf->KeyAt(index).size() == key.size() + sizeof(RID)) {
+          leaf->RemoveAt(index);
+          is_dirty = true;
+        } else {
+          index++;
+        }
+      }
+      if (index < leaf->GetSize()) {
+        break;
+      }
+      page = MoveToNextLeaf(page, true, is_dirty);
+      if (page == nullptr) {
+        return;
+      }
+      leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      index = 0;
+      is_dirty = false;
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+Page *VarLengthBPlusTree::FindLeafPage(std::string_view key, bool exclusive) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+
+  // pages are never freed, and a page keeps the type it was initialized with, so the type can be read before
+  // deciding which latch to take
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (exclusive && node->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!node->IsLeafPage()) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (exclusive && child->IsLeafPage()) {
+      child_page->WLatch();
+    } else {
+      child_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = child;
+  }
+  return page;
+}
+
+Page *VarLengthBPlusTree::FindLeafPageForInsert(std::string_view key, Transaction *transaction) {
+  // a page is safe if even an entry with the longest key fits, separators are never longer than the keys of leaves
+  auto is_safe = [](BPlusTreePage *node) {
+    return node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->HasRoom(LeafPage::MaxKeySize())
+                              : reinterpret_cast<InternalPage *>(node)->HasRoom(LeafPage::MaxKeySize());
+  };
+
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    ReleaseLatchedPages(transaction, false);
+    return nullptr;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch root page");
+  }
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (is_safe(node)) {
+    ReleaseLatchedPages(transaction, false);
+  }
+  transaction->AddIntoPageSet(page);
+
+  while (!node->IsLeafPage()) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page");
+    }
+    page->WLatch();
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (is_safe(node)) {
+      ReleaseLatchedPages(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+  }
+  return page;
+}
+
+Page *VarLengthBPlusTree::MoveToNextLeaf(Page *page, bool exclusive, bool is_dirty) {
+  // latching the next leaf while holding this one could deadlock with a writer going the other way, so it is only
+  // pinned; it cannot be freed, and a split of it only moves keys further right
+  page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+  Page *next_page = nullptr;
+  if (next_page_id != INVALID_PAGE_ID) {
+    next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch next leaf");
+    }
+  }
+  if (exclusive) {
+    page->WUnlatch();
+  } else {
+    page->RUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  if (next_page != nullptr) {
+    if (exclusive) {
+      next_page->WLatch();
+    } else {
+      next_page->RLatch();
+    }
+  }
+  return next_page;
+}
+
+void VarLengthBPlusTree::ReleaseLatchedPages(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  while (!page_set->empty()) {
+    Page *page = page_set->front();
+    page_set->pop_front();
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+    }
+  }
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * Call this method everytime root page id is changed.
+ * @parameter: insert_record      defualt value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+void VarLengthBPlusTree::UpdateRootPageId(int insert_record) {
+  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (insert_record != 0) {
+    // create a new record<index_name + root_page_id> in header_page
+    header_page->InsertRecord(index_name_, root_page_id_);
+  } else {
+    // update root_page_id in header_page
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+}  // namespace bustub
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/var_length_b_plus_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "storage/index/normalized_key.h"
+#include "storage/index/var_length_b_plus_tree_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+VarLengthBPlusTreeIndex::VarLengthBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata), container_(metadata->GetName(), buffer_pool_manager, metadata->IsUnique()) {}
+
+void VarLengthBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
+  container_.Insert(VarLengthKey::Encode(key, *GetKeySchema()), rid, transaction);
+}
+
+void VarLengthBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CountModification();
+  std::string index_key = VarLengthKey::Encode(key, *GetKeySchema());
+  // a non-unique key keeps its other tuples
+  if (GetMetadata()->IsUnique()) {
+    container_.Remove(index_key, transaction);
+  } else {
+    container_.Remove(index_key, rid, transaction);
+  }
+}
+
+void VarLengthBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  container_.GetValue(VarLengthKey::Encode(key, *GetKeySchema()), result, transaction);
+}
+
+}  // namespace bustub
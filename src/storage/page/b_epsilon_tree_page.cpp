@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_epsilon_tree_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "storage/page/b_epsilon_tree_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * LEAF PAGE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
+  BUSTUB_ASSERT(max_size > 0 && max_size <= Capacity(), "Leaf size out of range");
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetPageId(page_id);
+  SetParentPageId(INVALID_PAGE_ID);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_LEAF_PAGE_TYPE::Capacity() {
+  return (PAGE_SIZE - sizeof(BPlusTreePage)) / sizeof(MappingType);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_LEAF_PAGE_TYPE::Load(std::vector<MappingType> *pairs) const {
+  pairs->insert(pairs->end(), array_, array_ + GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_LEAF_PAGE_TYPE::Store(const MappingType *pairs, int size) {
+  BUSTUB_ASSERT(size <= GetMaxSize(), "Leaf page overflow");
+  std::copy(pairs, pairs + size, array_);
+  SetSize(size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_EPSILON_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value,
+                                          const KeyComparator &comparator) const {
+  auto key_less = [&comparator](const MappingType &pair, const KeyType &k) { return comparator(pair.first, k) < 0; };
+  auto it = std::lower_bound(array_, array_ + GetSize(), key, key_less);
+  if (it == array_ + GetSize() || comparator(it->first, key) != 0) {
+    return false;
+  }
+  *value = it->second;
+  return true;
+}
+
+/*****************************************************************************
+ * INTERNAL PAGE
+ *****************************************************************************/
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
+  static_assert(sizeof(BEpsilonTreeInternalPage) == B_EPSILON_TREE_INTERNAL_PAGE_HEADER_SIZE);
+  BUSTUB_ASSERT(max_size > 1 && BufferCapacity(max_size) > 0, "Internal size out of range");
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetMaxSize(max_size);
+  SetPageId(page_id);
+  SetParentPageId(INVALID_PAGE_ID);
+  buffer_size_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_INTERNAL_PAGE_TYPE::BufferCapacity(int max_size) {
+  int used = B_EPSILON_TREE_INTERNAL_PAGE_HEADER_SIZE + max_size * (sizeof(page_id_t) + sizeof(KeyType));
+  return std::max(PAGE_SIZE - used, 0) / static_cast<int>(sizeof(Message));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_INTERNAL_PAGE_TYPE::BufferCapacity() const { return BufferCapacity(GetMaxSize()); }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_INTERNAL_PAGE_TYPE::GetBufferSize() const { return buffer_size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t *B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Children() { return reinterpret_cast<page_id_t *>(data_); }
+
+INDEX_TEMPLATE_ARGUMENTS
+const page_id_t *B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Children() const {
+  return reinterpret_cast<const page_id_t *>(data_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType *B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Pivots() {
+  return reinterpret_cast<KeyType *>(data_ + GetMaxSize() * sizeof(page_id_t));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType *B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Pivots() const {
+  return reinterpret_cast<const KeyType *>(data_ + GetMaxSize() * sizeof(page_id_t));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Messages() -> Message * {
+  return reinterpret_cast<Message *>(data_ + GetMaxSize() * (sizeof(page_id_t) + sizeof(KeyType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Messages() const -> const Message * {
+  return reinterpret_cast<const Message *>(data_ + GetMaxSize() * (sizeof(page_id_t) + sizeof(KeyType)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_EPSILON_TREE_INTERNAL_PAGE_TYPE::ChildAt(int index) const { return Children()[index]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_INTERNAL_PAGE_TYPE::ChildIndex(const KeyType &key, const KeyComparator &comparator) const {
+  // the last child whose pivot is not greater than key, the invalid first pivot is less than any key
+  const KeyType *pivots = Pivots();
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(pivots[mid], key) <= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Load(std::vector<KeyType> *pivots, std::vector<page_id_t> *children,
+                                             std::vector<Message> *messages) const {
+  pivots->insert(pivots->end(), Pivots(), Pivots() + GetSize());
+  children->insert(children->end(), Children(), Children() + GetSize());
+  messages->insert(messages->end(), Messages(), Messages() + buffer_size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_INTERNAL_PAGE_TYPE::Store(const KeyType *pivots, const page_id_t *children, int size,
+                                              const Message *messages, int num_messages) {
+  BUSTUB_ASSERT(size > 0 && size <= GetMaxSize(), "Internal page overflow");
+  BUSTUB_ASSERT(num_messages <= BufferCapacity(), "Message buffer overflow");
+  std::copy(pivots + 1, pivots + size, Pivots() + 1);
+  std::copy(children, children + size, Children());
+  std::copy(messages, messages + num_messages, Messages());
+  SetSize(size);
+  buffer_size_ = num_messages;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_EPSILON_TREE_INTERNAL_PAGE_TYPE::UpperBound(const KeyType &key, const KeyComparator &comparator) const {
+  const Message *messages = Messages();
+  return std::upper_bound(messages, messages + buffer_size_, key,
+                          [&comparator](const KeyType &k, const Message &m) { return comparator(k, m.key_) < 0; }) -
+         messages;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_EPSILON_TREE_INTERNAL_PAGE_TYPE::InsertMessage(const Message &message, const KeyComparator &comparator) {
+  if (buffer_size_ == BufferCapacity()) {
+    return false;
+  }
+  Message *messages = Messages();
+  int index = UpperBound(message.key_, comparator);
+  memmove(static_cast<void *>(messages + index + 1), messages + index, (buffer_size_ - index) * sizeof(Message));
+  messages[index] = message;
+  buffer_size_++;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_EPSILON_TREE_INTERNAL_PAGE_TYPE::FindMessages(const KeyType &key, const KeyComparator &comparator,
+                                                     std::vector<Message> *messages) const {
+  const Message *buffer = Messages();
+  int end = UpperBound(key, comparator);
+  int begin = end;
+  while (begin > 0 && comparator(buffer[begin - 1].key_, key) == 0) {
+    begin--;
+  }
+  messages->insert(messages->end(), buffer + begin, buffer + end);
+}
+
+template class BEpsilonTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BEpsilonTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BEpsilonTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BEpsilonTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BEpsilonTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BEpsilonTreeInternalPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class BEpsilonTreeInternalPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class BEpsilonTreeInternalPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class BEpsilonTreeInternalPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class BEpsilonTreeInternalPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -9,10 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -25,34 +29,148 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compress) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  prefix_size_ = 0;
+  size_limit_ = compress ? max_size : 0;
+  Prefix::SetUnbounded(&low_key_, &high_key_);
+  SetMaxSize(compress ? MaxSizeFor(low_key_, high_key_) : max_size);
+}
+
+/*
+ * Helper methods to get/set the right sibling and the fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLowKey() const { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+/*
+ * Set new fences, all keys on the page but the invalid first one have to lie between them. A compressing page stores
+ * its pairs again if their prefix changes, and takes the max size that fits with it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetFences(const KeyType &low_key, const KeyType &high_key) {
+  int prefix_size = size_limit_ == 0 ? 0 : Prefix::CommonPrefix(low_key, high_key);
+  if (prefix_size != prefix_size_ || memcmp(&low_key, &low_key_, prefix_size) != 0) {
+    std::vector<MappingType> pairs;
+    pairs.reserve(GetSize());
+    for (int i = 0; i < GetSize(); i++) {
+      pairs.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    low_key_ = low_key;
+    prefix_size_ = prefix_size;
+    for (int i = 0; i < GetSize(); i++) {
+      SetItem(i, pairs[i]);
+    }
+  }
+  low_key_ = low_key;
+  high_key_ = high_key;
+  if (size_limit_ != 0) {
+    SetMaxSize(std::min(size_limit_, Capacity(prefix_size_) - 1));
+    BUSTUB_ASSERT(GetSize() <= GetMaxSize() + 1, "Pairs do not fit between the new fences");
+  }
+}
+
+/*
+ * @return the max size the page would have with the given fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeFor(const KeyType &low_key, const KeyType &high_key) const {
+  if (size_limit_ == 0) {
+    return GetMaxSize();
+  }
+  return std::min(size_limit_, Capacity(Prefix::CommonPrefix(low_key, high_key)) - 1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetPrefixSize() const { return prefix_size_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Capacity(int prefix_size) {
+  return static_cast<int>((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / Prefix::Stride(prefix_size));
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
+  if (prefix_size_ == 0) {
+    return array[index].first;
+  }
+  return Prefix::GetKey(EntryAt(index), low_key_, prefix_size_);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (prefix_size_ == 0) {
+    array[index].first = key;
+    return;
+  }
+  Prefix::SetKey(EntryAt(index), key, prefix_size_);
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { return 0; }
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  if (prefix_size_ == 0) {
+    return array[index].second;
+  }
+  return Prefix::GetValue(EntryAt(index), prefix_size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetItem(int index, const MappingType &pair) {
+  if (prefix_size_ == 0) {
+    array[index] = pair;
+    return;
+  }
+  Prefix::SetKey(EntryAt(index), pair.first, prefix_size_);
+  Prefix::SetValue(EntryAt(index), pair.second, prefix_size_);
+}
+
+/*
+ * Helper methods to find the stored pair at input "index", pairs are Prefix::Stride(prefix_size_) bytes apart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::EntryAt(int index) {
+  return reinterpret_cast<char *>(array) + index * Prefix::Stride(prefix_size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::EntryAt(int index) const {
+  return reinterpret_cast<const char *>(array) + index * Prefix::Stride(prefix_size_);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +182,23 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  return INVALID_PAGE_ID;
+  // find the last index whose key is <= key, the key at index 0 is invalid
+  if (prefix_size_ == 0) {
+    return array[KeySearch::UpperBound(array, 1, GetSize(), key, comparator) - 1].second;
+  }
+  return ValueAt(Prefix::template Search<true>(EntryAt(0), 1, GetSize(), key, low_key_, prefix_size_) - 1);
+}
+
+/*
+ * Find the child whose key range holds the keys right before key, for reverse scans
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupBefore(const KeyType &key, const KeyComparator &comparator) const {
+  // find the last index whose key is < key
+  if (prefix_size_ == 0) {
+    return array[KeySearch::LowerBound(array, 1, GetSize(), key, comparator) - 1].second;
+  }
+  return ValueAt(Prefix::template Search<false>(EntryAt(0), 1, GetSize(), key, low_key_, prefix_size_) - 1);
 }
 
 /*****************************************************************************
@@ -78,7 +212,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  Prefix::SetValue(EntryAt(0), old_value, prefix_size_);
+  SetItem(1, MappingType(new_key, new_value));
+  SetSize(2);
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -87,7 +225,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  return 0;
+  int index = ValueIndex(old_value) + 1;
+  memmove(EntryAt(index + 1), EntryAt(index), (GetSize() - index) * Prefix::Stride(prefix_size_));
+  SetItem(index, MappingType(new_key, new_value));
+  IncreaseSize(1);
+  return GetSize();
+}
+
+/*
+ * Add key & value pair after the last one and adopt the child, used to build pages bottom-up
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const ValueType &value,
+                                            BufferPoolManager *buffer_pool_manager) {
+  CopyLastFrom(MappingType(key, value), buffer_pool_manager);
 }
 
 /*****************************************************************************
@@ -98,14 +249,35 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  // the first key moved is the one pushed up into the parent, it stays as the recipient's invalid key
+  int keep = GetSize() / 2;
+  KeyType separator = KeyAt(keep);
+  recipient->SetFences(separator, high_key_);
+  recipient->CopyNFrom(this, keep, GetSize() - keep, buffer_pool_manager);
+  SetSize(keep);
+  SetFences(low_key_, separator);
+}
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
+/* Copy {size} entries of donor into me, starting from index {start}.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const BPlusTreeInternalPage *donor, int start, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
+  if (donor->prefix_size_ == prefix_size_ && memcmp(&donor->low_key_, &low_key_, prefix_size_) == 0) {
+    memcpy(EntryAt(GetSize()), donor->EntryAt(start), size * Prefix::Stride(prefix_size_));
+  } else {
+    for (int i = 0; i < size; i++) {
+      SetItem(GetSize() + i, MappingType(donor->KeyAt(start + i), donor->ValueAt(start + i)));
+    }
+  }
+  for (int i = 0; i < size; i++) {
+    Adopt(ValueAt(GetSize() + i), buffer_pool_manager);
+  }
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +288,21 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  memmove(EntryAt(index), EntryAt(index + 1), (GetSize() - index - 1) * Prefix::Stride(prefix_size_));
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return INVALID_PAGE_ID; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  ValueType only_child = ValueAt(0);
+  SetSize(0);
+  return only_child;
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -136,7 +315,14 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return IN
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               BufferPoolManager *buffer_pool_manager) {
+  int index = recipient->GetSize();
+  recipient->SetFences(recipient->low_key_, high_key_);
+  recipient->CopyNFrom(this, 0, GetSize(), buffer_pool_manager);
+  recipient->SetKeyAt(index, middle_key);
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -151,14 +337,25 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+                                                      BufferPoolManager *buffer_pool_manager) {
+  // my second key becomes the separator
+  KeyType separator = KeyAt(1);
+  recipient->SetFences(recipient->low_key_, separator);
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), buffer_pool_manager);
+  Remove(0);
+  SetFences(separator, high_key_);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  SetItem(GetSize(), pair);
+  Adopt(pair.second, buffer_pool_manager);
+  IncreaseSize(1);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -169,14 +366,44 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       BufferPoolManager *buffer_pool_manager) {
+  // my last key becomes the separator
+  KeyType separator = KeyAt(GetSize() - 1);
+  recipient->SetFences(separator, recipient->high_key_);
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom(MappingType(separator, ValueAt(GetSize() - 1)), buffer_pool_manager);
+  IncreaseSize(-1);
+  SetFences(low_key_, separator);
+}
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
+  memmove(EntryAt(1), EntryAt(0), GetSize() * Prefix::Stride(prefix_size_));
+  SetItem(0, pair);
+  Adopt(pair.second, buffer_pool_manager);
+  IncreaseSize(1);
+}
+
+/*
+ * Make me the parent of the child page, persisting the change through the buffer pool manager.
+ * A B-link tree does not keep parent page ids and passes no buffer pool manager.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(const ValueType &child, BufferPoolManager *buffer_pool_manager) {
+  if (buffer_pool_manager == nullptr) {
+    return;
+  }
+  Page *page = buffer_pool_manager->FetchPage(child);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch child page to adopt it");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child, true);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -184,4 +411,10 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template class BPlusTreeInternalPage<NormalizedKey<4>, page_id_t, NormalizedComparator<4>>;
+template class BPlusTreeInternalPage<NormalizedKey<8>, page_id_t, NormalizedComparator<8>>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
 }  // namespace bustub
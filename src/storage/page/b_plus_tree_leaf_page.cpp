@@ -9,10 +9,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -27,23 +31,93 @@ namespace bustub {
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool compress) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  prefix_size_ = 0;
+  size_limit_ = compress ? max_size : 0;
+  Prefix::SetUnbounded(&low_key_, &high_key_);
+  SetMaxSize(compress ? MaxSizeFor(low_key_, high_key_) : max_size);
+}
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return INVALID_PAGE_ID; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+/**
+ * Helper methods to get/set the fences, the high key is only meaningful while there is a next page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetLowKey() const { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+/*
+ * Set new fences, all keys on the page have to lie between them. A compressing page stores its pairs again if their
+ * prefix changes, and takes the max size that fits with it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetFences(const KeyType &low_key, const KeyType &high_key) {
+  int prefix_size = size_limit_ == 0 ? 0 : Prefix::CommonPrefix(low_key, high_key);
+  if (prefix_size != prefix_size_ || memcmp(&low_key, &low_key_, prefix_size) != 0) {
+    std::vector<MappingType> items;
+    items.reserve(GetSize());
+    for (int i = 0; i < GetSize(); i++) {
+      items.push_back(GetItem(i));
+    }
+    low_key_ = low_key;
+    prefix_size_ = prefix_size;
+    for (int i = 0; i < GetSize(); i++) {
+      SetItem(i, items[i]);
+    }
+  }
+  low_key_ = low_key;
+  high_key_ = high_key;
+  if (size_limit_ != 0) {
+    SetMaxSize(std::min(size_limit_, Capacity(prefix_size_)));
+    BUSTUB_ASSERT(GetSize() <= GetMaxSize(), "Pairs do not fit between the new fences");
+  }
+}
+
+/*
+ * @return the max size the page would have with the given fences
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeFor(const KeyType &low_key, const KeyType &high_key) const {
+  if (size_limit_ == 0) {
+    return GetMaxSize();
+  }
+  return std::min(size_limit_, Capacity(Prefix::CommonPrefix(low_key, high_key)));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrefixSize() const { return prefix_size_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+int B_PLUS_TREE_LEAF_PAGE_TYPE::Capacity(int prefix_size) {
+  return static_cast<int>((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - 2 * sizeof(KeyType)) / Prefix::Stride(prefix_size));
+}
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  if (prefix_size_ == 0) {
+    return KeySearch::LowerBound(array, 0, GetSize(), key, comparator);
+  }
+  return Prefix::template Search<false>(EntryAt(0), 0, GetSize(), key, low_key_, prefix_size_);
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
@@ -51,9 +125,18 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
+  if (prefix_size_ == 0) {
+    return array[index].first;
+  }
+  return Prefix::GetKey(EntryAt(index), low_key_, prefix_size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  if (prefix_size_ == 0) {
+    return array[index].second;
+  }
+  return Prefix::GetValue(EntryAt(index), prefix_size_);
 }
 
 /*
@@ -61,9 +144,35 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array[0];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  if (prefix_size_ == 0) {
+    return array[index];
+  }
+  const char *entry = EntryAt(index);
+  return MappingType(Prefix::GetKey(entry, low_key_, prefix_size_), Prefix::GetValue(entry, prefix_size_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetItem(int index, const MappingType &item) {
+  if (prefix_size_ == 0) {
+    array[index] = item;
+    return;
+  }
+  Prefix::SetKey(EntryAt(index), item.first, prefix_size_);
+  Prefix::SetValue(EntryAt(index), item.second, prefix_size_);
+}
+
+/*
+ * Helper methods to find the stored pair at input "index", pairs are Prefix::Stride(prefix_size_) bytes apart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(int index) {
+  return reinterpret_cast<char *>(array) + index * Prefix::Stride(prefix_size_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::EntryAt(int index) const {
+  return reinterpret_cast<const char *>(array) + index * Prefix::Stride(prefix_size_);
 }
 
 /*****************************************************************************
@@ -75,23 +184,63 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    return GetSize();
+  }
+  InsertAt(index, key, value);
+  return GetSize();
+}
+
+/*
+ * Insert key & value pair at input "index", the caller keeps the keys in order
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  memmove(EntryAt(index + 1), EntryAt(index), (GetSize() - index) * Prefix::Stride(prefix_size_));
+  SetItem(index, MappingType(key, value));
+  IncreaseSize(1);
 }
 
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page, the first key moved separates the two.
+ * The pairs of a repeated key stay together, so the split is moved to the nearest change of key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyComparator &comparator) {
+  auto is_split = [&](int index) {
+    return index > 0 && index < GetSize() && comparator(KeyAt(index - 1), KeyAt(index)) != 0;
+  };
+  int half = GetSize() / 2;
+  int keep = half;
+  for (int offset = 1; !is_split(keep); offset++) {
+    BUSTUB_ASSERT(offset < GetSize(), "A leaf with a single key cannot split");
+    keep = is_split(half - offset) ? half - offset : half + offset;
+  }
+  KeyType separator = KeyAt(keep);
+  recipient->SetFences(separator, high_key_);
+  recipient->CopyNFrom(this, keep, GetSize() - keep);
+  SetSize(keep);
+  SetFences(low_key_, separator);
+}
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Copy {size} number of elements of donor, starting from index {start}, into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const BPlusTreeLeafPage *donor, int start, int size) {
+  if (donor->prefix_size_ == prefix_size_ && memcmp(&donor->low_key_, &low_key_, prefix_size_) == 0) {
+    memcpy(EntryAt(GetSize()), donor->EntryAt(start), size * Prefix::Stride(prefix_size_));
+  } else {
+    for (int i = 0; i < size; i++) {
+      SetItem(GetSize() + i, donor->GetItem(start + i));
+    }
+  }
+  IncreaseSize(size);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -103,6 +252,11 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    *value = GetItem(index).second;
+    return true;
+  }
   return false;
 }
 
@@ -116,7 +270,31 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
+    RemoveAt(index);
+  }
+  return GetSize();
+}
+
+/*
+ * Remove the key & value pair at input "index"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  memmove(EntryAt(index), EntryAt(index + 1), (GetSize() - index - 1) * Prefix::Stride(prefix_size_));
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  if (prefix_size_ == 0) {
+    array[index].second = value;
+    return;
+  }
+  Prefix::SetValue(EntryAt(index), value, prefix_size_);
+}
 
 /*****************************************************************************
  * MERGE
@@ -126,38 +304,75 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->SetFences(recipient->low_key_, high_key_);
+  recipient->CopyNFrom(this, 0, GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
- * Remove the first key & value pair from this page to "recipient" page.
+ * Remove the first key & value pair from this page to "recipient" page. My second key becomes the separator.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  KeyType separator = KeyAt(1);
+  recipient->SetFences(recipient->low_key_, separator);
+  recipient->CopyLastFrom(GetItem(0));
+  memmove(EntryAt(0), EntryAt(1), (GetSize() - 1) * Prefix::Stride(prefix_size_));
+  IncreaseSize(-1);
+  SetFences(separator, high_key_);
+}
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  SetItem(GetSize(), item);
+  IncreaseSize(1);
+}
 
 /*
- * Remove the last key & value pair from this page to "recipient" page.
+ * Remove the last key & value pair from this page to "recipient" page. The key moved becomes the separator.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  KeyType separator = KeyAt(GetSize() - 1);
+  recipient->SetFences(separator, recipient->high_key_);
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
+  IncreaseSize(-1);
+  SetFences(low_key_, separator);
+}
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  memmove(EntryAt(1), EntryAt(0), GetSize() * Prefix::Stride(prefix_size_));
+  SetItem(0, item);
+  IncreaseSize(1);
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTreeLeafPage<GenericKey<4>, CoveringValue<4>, GenericComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, CoveringValue<16>, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, CoveringValue<32>, GenericComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, CoveringValue<64>, GenericComparator<64>>;
 }  // namespace bustub
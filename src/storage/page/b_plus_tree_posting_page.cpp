@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+void BPlusTreePostingPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+}
+
+page_id_t BPlusTreePostingPage::GetNextPageId() const { return next_page_id_; }
+
+void BPlusTreePostingPage::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+int BPlusTreePostingPage::GetSize() const { return size_; }
+
+bool BPlusTreePostingPage::IsFull() const { return size_ == POSTING_PAGE_SIZE; }
+
+RID BPlusTreePostingPage::ValueAt(int index) const { return array_[index]; }
+
+bool BPlusTreePostingPage::Contains(const RID &value) const {
+  int index = ValueIndex(value);
+  return index < size_ && array_[index] == value;
+}
+
+RID BPlusTreePostingPage::MakeReference(page_id_t page_id) { return RID(page_id, REFERENCE_SLOT); }
+
+bool BPlusTreePostingPage::IsReference(const RID &value, page_id_t *page_id) {
+  if (value.GetSlotNum() != REFERENCE_SLOT) {
+    return false;
+  }
+  *page_id = value.GetPageId();
+  return true;
+}
+
+bool BPlusTreePostingPage::Less(const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); }
+
+int BPlusTreePostingPage::ValueIndex(const RID &value) const {
+  return static_cast<int>(std::lower_bound(array_, array_ + size_, value, Less) - array_);
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+
+bool BPlusTreePostingPage::Insert(const RID &value) {
+  int index = ValueIndex(value);
+  if (index < size_ && array_[index] == value) {
+    return false;
+  }
+  std::copy_backward(array_ + index, array_ + size_, array_ + size_ + 1);
+  array_[index] = value;
+  size_++;
+  return true;
+}
+
+bool BPlusTreePostingPage::Remove(const RID &value) {
+  int index = ValueIndex(value);
+  if (index == size_ || !(array_[index] == value)) {
+    return false;
+  }
+  std::copy(array_ + index + 1, array_ + size_, array_ + index);
+  size_--;
+  return true;
+}
+
+void BPlusTreePostingPage::Append(const RID &value) { array_[size_++] = value; }
+
+void BPlusTreePostingPage::MoveHalfTo(BPlusTreePostingPage *recipient) {
+  int keep = size_ / 2;
+  std::copy(array_ + keep, array_ + size_, recipient->array_ + recipient->size_);
+  recipient->size_ += size_ - keep;
+  recipient->next_page_id_ = next_page_id_;
+  size_ = keep;
+}
+
+}  // namespace bustub
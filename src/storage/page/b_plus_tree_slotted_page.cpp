@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_slotted_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::Init(page_id_t page_id) {
+  static_assert(sizeof(BPlusTreeSlottedPage) == SLOTTED_PAGE_HEADER_SIZE);
+  SetPageType(std::is_same_v<ValueType, RID> ? IndexPageType::LEAF_PAGE : IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetMaxSize(0);
+  SetPageId(page_id);
+  SetParentPageId(INVALID_PAGE_ID);
+  next_page_id_ = INVALID_PAGE_ID;
+  free_offset_ = PAGE_SIZE;
+  garbage_ = 0;
+}
+
+template <typename ValueType>
+page_id_t BPlusTreeSlottedPage<ValueType>::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename ValueType>
+std::string_view BPlusTreeSlottedPage<ValueType>::KeyAt(int index) const {
+  return std::string_view(EntryAt(index), slots_[index].key_size_);
+}
+
+template <typename ValueType>
+ValueType BPlusTreeSlottedPage<ValueType>::ValueAt(int index) const {
+  ValueType value;
+  memcpy(reinterpret_cast<char *>(&value), EntryAt(index) + slots_[index].key_size_, sizeof(ValueType));
+  return value;
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::SetValueAt(int index, const ValueType &value) {
+  memcpy(EntryAt(index) + slots_[index].key_size_, reinterpret_cast<const char *>(&value), sizeof(ValueType));
+}
+
+template <typename ValueType>
+int BPlusTreeSlottedPage<ValueType>::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return GetSize();
+}
+
+template <typename ValueType>
+int BPlusTreeSlottedPage<ValueType>::KeyIndex(std::string_view key) const {
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (KeyAt(mid) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+template <typename ValueType>
+ValueType BPlusTreeSlottedPage<ValueType>::Lookup(std::string_view key) const {
+  // the last child whose key is not greater than key, the invalid first key is less than any other
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (KeyAt(mid) <= key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return ValueAt(low - 1);
+}
+
+template <typename ValueType>
+size_t BPlusTreeSlottedPage<ValueType>::FreeSpace() const {
+  return free_offset_ - SLOTTED_PAGE_HEADER_SIZE - GetSize() * sizeof(Slot) + garbage_;
+}
+
+template <typename ValueType>
+bool BPlusTreeSlottedPage<ValueType>::HasRoom(size_t key_size) const {
+  return FreeSpace() >= sizeof(Slot) + key_size + sizeof(ValueType);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::Compact() {
+  char buffer[PAGE_SIZE];
+  uint32_t offset = PAGE_SIZE;
+  for (int i = 0; i < GetSize(); i++) {
+    size_t entry_size = slots_[i].key_size_ + sizeof(ValueType);
+    offset -= entry_size;
+    memcpy(buffer + offset, EntryAt(i), entry_size);
+    slots_[i].offset_ = offset;
+  }
+  memcpy(reinterpret_cast<char *>(this) + offset, buffer + offset, PAGE_SIZE - offset);
+  free_offset_ = offset;
+  garbage_ = 0;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::InsertAt(int index, std::string_view key, const ValueType &value) {
+  BUSTUB_ASSERT(HasRoom(key.size()), "Slotted page overflow");
+  size_t entry_size = key.size() + sizeof(ValueType);
+  if (FreeSpace() - garbage_ < sizeof(Slot) + entry_size) {
+    Compact();
+  }
+  free_offset_ -= entry_size;
+  memmove(slots_ + index + 1, slots_ + index, (GetSize() - index) * sizeof(Slot));
+  slots_[index].offset_ = free_offset_;
+  slots_[index].key_size_ = key.size();
+  memcpy(EntryAt(index), key.data(), key.size());
+  IncreaseSize(1);
+  SetValueAt(index, value);
+}
+
+template <typename ValueType>
+void BPlusTreeSlottedPage<ValueType>::RemoveAt(int index) {
+  garbage_ += slots_[index].key_size_ + sizeof(ValueType);
+  memmove(slots_ + index, slots_ + index + 1, (GetSize() - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+  if (GetSize() == 0) {
+    free_offset_ = PAGE_SIZE;
+    garbage_ = 0;
+  }
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+
+template <typename ValueType>
+std::string BPlusTreeSlottedPage<ValueType>::MoveHalfTo(BPlusTreeSlottedPage *recipient) {
+  size_t used = PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE - FreeSpace();
+  size_t kept = 0;
+  int keep = 0;
+  while (keep < GetSize() - 1) {
+    size_t entry_size = sizeof(Slot) + slots_[keep].key_size_ + sizeof(ValueType);
+    if (keep > 0 && kept + entry_size > used / 2) {
+      break;
+    }
+    kept += entry_size;
+    keep++;
+  }
+
+  std::string separator(KeyAt(keep));
+  bool leaf = IsLeafPage();
+  for (int i = keep; i < GetSize(); i++) {
+    recipient->InsertAt(i - keep, leaf || i > keep ? KeyAt(i) : std::string_view(), ValueAt(i));
+  }
+  SetSize(keep);
+  Compact();
+
+  if (leaf) {
+    std::string_view last = KeyAt(keep - 1);
+    size_t common = std::mismatch(last.begin(), last.end(), separator.begin(), separator.end()).first - last.begin();
+    separator.resize(std::min(common + 1, separator.size()));
+  }
+  return separator;
+}
+
+template class BPlusTreeSlottedPage<RID>;
+template class BPlusTreeSlottedPage<page_id_t>;
+
+}  // namespace bustub
@@ -0,0 +1,175 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_bucket_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "storage/page/hash_table_bucket_page.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  static_assert(sizeof(HashTableBucketPage) + BUCKET_ARRAY_SIZE * sizeof(MappingType) <= PAGE_SIZE,
+                "Bucket does not fit a page");
+  next_page_id_ = INVALID_PAGE_ID;
+  memset(occupied_, 0, sizeof(occupied_));
+  memset(readable_, 0, sizeof(readable_));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_BUCKET_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(const KeyType &key, const KeyComparator &comparator,
+                                      std::vector<ValueType> *result) const {
+  bool found = false;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && comparator(array_[i].first, key) == 0) {
+      result->push_back(array_[i].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Contains(const KeyType &key, const ValueType &value,
+                                      const KeyComparator &comparator) const {
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && comparator(array_[i].first, key) == 0 && array_[i].second == value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+  slot_offset_t free_slot = BUCKET_ARRAY_SIZE;
+  slot_offset_t i = 0;
+  for (; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (!IsReadable(i)) {
+      free_slot = std::min(free_slot, i);
+    } else if (comparator(array_[i].first, key) == 0 && array_[i].second == value) {
+      return false;
+    }
+  }
+  free_slot = std::min(free_slot, i);
+  if (free_slot == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_slot] = MappingType(key, value);
+  SetOccupied(free_slot);
+  SetReadable(free_slot, true);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && comparator(array_[i].first, key) == 0 && array_[i].second == value) {
+      RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(slot_offset_t bucket_idx) const {
+  return array_[bucket_idx].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(slot_offset_t bucket_idx) const {
+  return array_[bucket_idx].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(slot_offset_t bucket_idx) {
+  SetReadable(bucket_idx, false);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsOccupied(slot_offset_t bucket_idx) const {
+  return (occupied_[bucket_idx / 8] >> (bucket_idx % 8) & 1) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsReadable(slot_offset_t bucket_idx) const {
+  return (readable_[bucket_idx / 8] >> (bucket_idx % 8) & 1) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(slot_offset_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetReadable(slot_offset_t bucket_idx, bool readable) {
+  if (readable) {
+    readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+  } else {
+    readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() const {
+  uint32_t count = 0;
+  for (char flags : readable_) {
+    count += __builtin_popcount(static_cast<unsigned char>(flags));
+  }
+  return count;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
+  return NumReadable() == BUCKET_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
+  for (char flags : readable_) {
+    if (flags != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// DO NOT REMOVE ANYTHING BELOW THIS LINE
+template class HashTableBucketPage<int, int, IntComparator>;
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class HashTableBucketPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class HashTableBucketPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class HashTableBucketPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class HashTableBucketPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class HashTableBucketPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
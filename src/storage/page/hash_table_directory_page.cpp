@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <unordered_map>
+
+#include "common/macros.h"
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "Directory does not fit a page");
+  page_id_ = page_id;
+  lsn_ = INVALID_LSN;
+  global_depth_ = 0;
+  local_depths_[0] = 0;
+  bucket_page_ids_[0] = bucket_page_id;
+}
+
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryPage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return Size() - 1; }
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  BUSTUB_ASSERT(global_depth_ < DIRECTORY_MAX_DEPTH, "Directory is full");
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[size + i] = local_depths_[i];
+    bucket_page_ids_[size + i] = bucket_page_ids_[i];
+  }
+  global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  BUSTUB_ASSERT(CanShrink(), "Directory cannot shrink");
+  global_depth_--;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  BUSTUB_ASSERT(local_depth <= global_depth_, "Local depth exceeds global depth");
+  local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) const {
+  return (1U << local_depths_[bucket_idx]) - 1;
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  BUSTUB_ASSERT(local_depths_[bucket_idx] > 0, "Bucket has no split image");
+  return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
+}
+
+void HashTableDirectoryPage::VerifyIntegrity() const {
+  std::unordered_map<page_id_t, uint32_t> entries;
+  std::unordered_map<page_id_t, uint32_t> local_depths;
+  for (uint32_t i = 0; i < Size(); i++) {
+    BUSTUB_ASSERT(local_depths_[i] <= global_depth_, "Local depth exceeds global depth");
+    auto [it, inserted] = local_depths.emplace(bucket_page_ids_[i], local_depths_[i]);
+    BUSTUB_ASSERT(inserted || it->second == local_depths_[i], "Entries of a bucket disagree on its local depth");
+    entries[bucket_page_ids_[i]]++;
+  }
+  for (const auto &[bucket_page_id, count] : entries) {
+    BUSTUB_ASSERT(count == 1U << (global_depth_ - local_depths[bucket_page_id]), "Bucket has the wrong entry count");
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_fingerprint_block_page.cpp
+//
+// Identification: src/storage/page/hash_table_fingerprint_block_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+#include "common/macros.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/normalized_key.h"
+#include "storage/page/hash_table_fingerprint_block_page.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_FINGERPRINT_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_FINGERPRINT_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_FINGERPRINT_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                               uint8_t fingerprint) {
+  static_assert(sizeof(std::atomic<uint8_t>) == 1, "Control bytes are matched as plain bytes");
+  static_assert(FINGERPRINT_CONTROL_SIZE + FINGERPRINT_BLOCK_ARRAY_SIZE * sizeof(MappingType) <= PAGE_SIZE,
+                "Block does not fit a page");
+  BUSTUB_ASSERT((fingerprint & 0x80) != 0, "Not a fingerprint");
+  uint8_t expected = EMPTY;
+  if (!control_[bucket_ind].compare_exchange_strong(expected, CLAIMED)) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  control_[bucket_ind].store(fingerprint);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_FINGERPRINT_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  control_[bucket_ind].store(TOMBSTONE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_FINGERPRINT_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
+  return control_[bucket_ind].load() != EMPTY;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_FINGERPRINT_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
+  return (control_[bucket_ind].load() & 0x80) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_FINGERPRINT_BLOCK_TYPE::MatchGroup(slot_offset_t bucket_ind, uint8_t fingerprint,
+                                                       uint32_t *empty) const {
+  uint32_t match = 0;
+  uint32_t free = 0;
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(control_ + bucket_ind));
+  match = _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(fingerprint))));
+  free = _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_setzero_si256()));
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(control_ + bucket_ind));
+  match = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(fingerprint))));
+  free = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_setzero_si128()));
+#else
+  for (size_t i = 0; i < GROUP_SIZE; i++) {
+    uint8_t control = control_[bucket_ind + i].load(std::memory_order_relaxed);
+    match |= static_cast<uint32_t>(control == fingerprint) << i;
+    free |= static_cast<uint32_t>(control == EMPTY) << i;
+  }
+#endif
+  size_t width = FINGERPRINT_BLOCK_ARRAY_SIZE - bucket_ind;
+  uint32_t in_block = width < 32 ? (1U << width) - 1 : ~0U;
+  *empty = free & in_block;
+  return match & in_block;
+}
+
+// DO NOT REMOVE ANYTHING BELOW THIS LINE
+template class HashTableFingerprintBlockPage<int, int, IntComparator>;
+template class HashTableFingerprintBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableFingerprintBlockPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableFingerprintBlockPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableFingerprintBlockPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableFingerprintBlockPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class HashTableFingerprintBlockPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class HashTableFingerprintBlockPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class HashTableFingerprintBlockPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class HashTableFingerprintBlockPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class HashTableFingerprintBlockPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
@@ -189,6 +189,34 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   return TableIterator(this, rid, txn);
 }
 
+std::vector<page_id_t> TableHeap::GetPageIds() {
+  std::vector<page_id_t> page_ids;
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(page_id);
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids.back(), false);
+  }
+  return page_ids;
+}
+
+void TableHeap::ScanPage(page_id_t page_id, const std::function<void(const Tuple &)> &callback, Transaction *txn) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  page->RLatch();
+  RID rid;
+  Tuple tuple;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    if (page->GetTuple(rid, &tuple, txn, lock_manager_)) {
+      callback(tuple);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
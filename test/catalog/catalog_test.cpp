@@ -10,19 +10,22 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(CatalogTest, DISABLED_CreateTableTest) {
+TEST(CatalogTest, CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
   auto bpm = new BufferPoolManager(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
@@ -38,14 +41,279 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 
   Schema schema(columns);
   auto *table_metadata = catalog->CreateTable(nullptr, table_name, schema);
-  (void)table_metadata;
+  EXPECT_EQ(table_metadata, catalog->GetTable(table_name));
+  EXPECT_EQ(table_metadata, catalog->GetTable(table_metadata->oid_));
+  EXPECT_EQ(table_name, table_metadata->name_);
+  EXPECT_EQ(2, table_metadata->schema_.GetColumnCount());
+  EXPECT_TRUE(catalog->GetTableIndexes(table_name).empty());
 
-  // Notice that this test case doesn't check anything! :(
-  // It is up to you to extend it
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  // indexes keep their root page ids in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::BIGINT);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // rows arrive in an order unrelated to the key
+  const int num_rows = 2000;
+  std::vector<RID> rids(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    int64_t key = (i * 7919) % num_rows;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(key)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rids[key], &txn));
+  }
+
+  std::vector<uint32_t> key_attrs{1};
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, key_attrs));
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn, "potato_b", "potato", schema,
+                                                                                      *key_schema, key_attrs, 8);
+  EXPECT_EQ(index_info, catalog->GetIndex("potato_b", "potato"));
+  EXPECT_EQ(index_info, catalog->GetIndex(index_info->index_oid_));
+  ASSERT_EQ(1, catalog->GetTableIndexes("potato").size());
+  EXPECT_THROW(catalog->GetIndex("potato_a", "potato"), std::out_of_range);
+
+  // every existing row can be found through the index, and a scan returns them in key order
+  auto *index = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
+  ASSERT_NE(nullptr, index);
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_rows; key++) {
+    result.clear();
+    Tuple key_tuple({ValueFactory::GetBigIntValue(key)}, key_schema.get());
+    index->ScanKey(key_tuple, &result, &txn);
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(rids[key], result[0]);
+  }
+  int64_t key = 0;
+  for (auto it = index->GetBeginIterator(); it != index->GetEndIterator(); ++it) {
+    EXPECT_EQ(rids[key], (*it).second);
+    key++;
+  }
+  EXPECT_EQ(num_rows, key);
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ParallelCreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::BIGINT);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // rows of a key are spread over the table pages, and so over the runs of the workers
+  const int num_rows = 5000;
+  const int num_keys = 1000;
+  std::vector<RID> rids(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(i % num_keys)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rids[i], &txn));
+  }
+  ASSERT_GT(table_metadata->table_->GetPageIds().size(), 4);
+
+  std::vector<uint32_t> key_attrs{1};
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, key_attrs));
+  auto *all_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "potato_b", "potato", schema, *key_schema, key_attrs, 8, false, {}, 4);
+  auto *first_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "potato_b_first", "potato", schema, *key_schema, key_attrs, 8, true, {}, 4);
+  auto *all = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(all_info->index_.get());
+  Index *first = first_info->index_.get();
+
+  // every row, by key and then by record id (rows were inserted in record id order)
+  std::vector<RID> expected;
+  for (int key = 0; key < num_keys; key++) {
+    for (int i = key; i < num_rows; i += num_keys) {
+      expected.push_back(rids[i]);
+    }
+  }
+  size_t count = 0;
+  for (auto it = all->GetBeginIterator(); it != all->GetEndIterator(); ++it) {
+    ASSERT_LT(count, expected.size());
+    EXPECT_EQ(expected[count], (*it).second);
+    count++;
+  }
+  EXPECT_EQ(expected.size(), count);
+
+  // a unique index keeps the first row of each key
+  std::vector<RID> result;
+  for (int key = 0; key < num_keys; key++) {
+    result.clear();
+    first->ScanKey(Tuple({ValueFactory::GetBigIntValue(key)}, key_schema.get()), &result, &txn);
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(rids[key], result[0]);
+  }
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, AnalyzeIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::BIGINT);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  const int num_rows = 5000;
+  const int num_keys = 1000;
+  RID rid;
+  for (int i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(i % num_keys)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+  }
+
+  std::vector<uint32_t> b_attrs{1};
+  std::unique_ptr<Schema> b_schema(Schema::CopySchema(&schema, b_attrs));
+  auto *b_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn, "potato_b", "potato", schema,
+                                                                                *b_schema, b_attrs, 8, false);
+  std::vector<uint32_t> a_attrs{0};
+  std::unique_ptr<Schema> a_schema(Schema::CopySchema(&schema, a_attrs));
+  catalog->CreateIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>(&txn, "potato_a", "potato", schema, *a_schema,
+                                                                       a_attrs, 8);
+  EXPECT_EQ(nullptr, b_info->statistics_);
+
+  // every key has five rows, the distinct keys are estimated to within a few percent
+  std::shared_ptr<const IndexStatistics> b_stats = catalog->AnalyzeIndex(&txn, "potato_b", "potato");
+  EXPECT_EQ(b_info->statistics_, b_stats);
+  EXPECT_EQ(num_rows, b_stats->num_entries_);
+  EXPECT_NEAR(num_keys, b_stats->distinct_keys_, num_keys * 0.05);
+  EXPECT_GE(b_stats->height_, 2);
+  EXPECT_GT(b_stats->num_pages_, 1);
+  EXPECT_GT(b_stats->fill_factor_, 0.5);
+  EXPECT_LE(b_stats->fill_factor_, 1.0);
+
+  // the histogram covers all keys in increasing order, and the keys are spread evenly
+  ASSERT_GT(b_stats->histogram_bounds_.size(), 2);
+  EXPECT_EQ(0, b_stats->histogram_bounds_.front().GetAs<int64_t>());
+  EXPECT_EQ(num_keys - 1, b_stats->histogram_bounds_.back().GetAs<int64_t>());
+  for (size_t i = 1; i < b_stats->histogram_bounds_.size(); i++) {
+    EXPECT_LE(b_stats->histogram_bounds_[i - 1].GetAs<int64_t>(), b_stats->histogram_bounds_[i].GetAs<int64_t>());
+  }
+  EXPECT_NEAR(0.25, b_stats->EstimateRangeFraction(ValueFactory::GetBigIntValue(0), ValueFactory::GetBigIntValue(250)),
+              0.05);
+  EXPECT_NEAR(0.5, b_stats->EstimateRangeFraction(ValueFactory::GetBigIntValue(250), ValueFactory::GetBigIntValue(750)),
+              0.05);
+  EXPECT_DOUBLE_EQ(0, b_stats->EstimateRangeFraction(ValueFactory::GetBigIntValue(num_keys),
+                                                     ValueFactory::GetBigIntValue(2 * num_keys)));
+
+  // normalized keys cannot be decoded, so there is no histogram
+  std::shared_ptr<const IndexStatistics> a_stats = catalog->AnalyzeIndex(&txn, "potato_a", "potato");
+  EXPECT_EQ(num_rows, a_stats->num_entries_);
+  EXPECT_NEAR(num_rows, a_stats->distinct_keys_, num_rows * 0.05);
+  EXPECT_TRUE(a_stats->histogram_bounds_.empty());
+
+  // the statistics are kept until a tenth of the entries changed
+  const int num_changes = static_cast<int>(num_rows * Catalog::REANALYZE_FRACTION);
+  for (int i = 0; i < num_changes - 1; i++) {
+    Tuple key({ValueFactory::GetBigIntValue(num_keys + i)}, b_schema.get());
+    b_info->index_->InsertEntry(key, RID(num_rows + i, 0), &txn);
+  }
+  EXPECT_EQ(b_stats, catalog->GetIndexStatistics(&txn, "potato_b", "potato"));
+  Tuple key({ValueFactory::GetBigIntValue(num_keys)}, b_schema.get());
+  b_info->index_->DeleteEntry(key, RID(num_rows, 0), &txn);
+  std::shared_ptr<const IndexStatistics> b_fresh = catalog->GetIndexStatistics(&txn, "potato_b", "potato");
+  EXPECT_NE(b_stats, b_fresh);
+  EXPECT_EQ(b_info->statistics_, b_fresh);
+  EXPECT_EQ(num_rows + num_changes - 2, b_fresh->num_entries_);
+  EXPECT_EQ(b_fresh, catalog->GetIndexStatistics(&txn, "potato_b", "potato"));
+  // the statistics handed out before stay as they were
+  EXPECT_EQ(num_rows, b_stats->num_entries_);
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateVarLengthIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 500);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // long strings, a few rows each
+  const int num_rows = 300;
+  std::vector<RID> rids(num_rows);
+  auto name_of = [](int i) { return std::string(i % 150 * 3, 'x') + std::to_string(i % 150); };
+  for (int i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(name_of(i))}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rids[i], &txn));
+  }
+
+  std::vector<uint32_t> key_attrs{1};
+  std::unique_ptr<Schema> key_schema(Schema::CopySchema(&schema, key_attrs));
+  auto *index_info =
+      catalog->CreateVarLengthIndex(&txn, "potato_b", "potato", schema, *key_schema, key_attrs, false);
+  EXPECT_EQ(index_info, catalog->GetIndex("potato_b", "potato"));
+  EXPECT_EQ(0, index_info->key_size_);
+
+  std::vector<RID> result;
+  for (int i = 0; i < num_rows; i++) {
+    result.clear();
+    Tuple key_tuple({ValueFactory::GetVarcharValue(name_of(i))}, key_schema.get());
+    index_info->index_->ScanKey(key_tuple, &result, &txn);
+    EXPECT_EQ(2, result.size());
+    EXPECT_NE(result.end(), std::find(result.begin(), result.end(), rids[i]));
+  }
 
   delete catalog;
   delete bpm;
   delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
 }
 
 }  // namespace bustub
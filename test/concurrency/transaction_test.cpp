@@ -26,6 +26,7 @@
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
+#include "storage/index/covering_value.h"
 #include "type/value_factory.h"
 
 #define TEST_TIMEOUT_BEGIN                           \
@@ -251,4 +252,54 @@ TEST_F(TransactionTest, DISABLED_DirtyReadsTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, CoveringIndexDeleteRollbackTest) {
+  // txn1: DELETE FROM test_1 WHERE colA = <first row>, on an index on colA that includes colB and colD
+  // txn1: abort
+  // the index-only scan of the row returns its included columns again
+
+  auto *catalog = GetCatalog();
+  auto table_info = catalog->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = catalog->CreateIndex<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>(
+      GetTxn(), "test_1_colA", "test_1", schema, *key_schema, {0}, 8, true, {1, 3});
+  Index *index = index_info->index_.get();
+
+  Tuple tuple = *table_info->table_->Begin(GetTxn());
+  RID rid = tuple.GetRid();
+  int32_t a = tuple.GetValue(&schema, schema.GetColIdx("colA")).GetAs<int32_t>();
+  Tuple key = tuple.KeyFromTuple(schema, *key_schema, {0});
+  Tuple high_key({ValueFactory::GetIntegerValue(a + 1)}, key_schema);
+
+  // the two-argument insert would lose the included columns
+  EXPECT_THROW(index->InsertEntry(key, rid, GetTxn()), Exception);
+
+  Transaction *txn1 = GetTxnManager()->Begin();
+  index->DeleteEntry(key, rid, txn1);
+  txn1->GetIndexWriteSet()->emplace_back(rid, table_info->oid_, WType::DELETE, tuple, index_info->index_oid_, catalog);
+  GetTxnManager()->Abort(txn1);
+  CheckAborted(txn1);
+
+  const Schema &covered_schema = *index->GetMetadata()->GetCoveredSchema();
+  std::vector<Tuple> result_set;
+  index->ScanRange(
+      &key, &high_key,
+      [&](const Tuple &covered, RID covered_rid) {
+        EXPECT_EQ(rid, covered_rid);
+        result_set.push_back(covered);
+        return true;
+      },
+      GetTxn());
+  ASSERT_EQ(1, result_set.size());
+  for (const auto *column : {"colA", "colB", "colD"}) {
+    EXPECT_EQ(tuple.GetValue(&schema, schema.GetColIdx(column)).GetAs<int32_t>(),
+              result_set[0].GetValue(&covered_schema, covered_schema.GetColIdx(column)).GetAs<int32_t>())
+        << column;
+  }
+
+  delete txn1;
+  delete key_schema;
+}
+
 }  // namespace bustub
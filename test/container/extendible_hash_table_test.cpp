@@ -0,0 +1,220 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key, duplicate values for the same key are not allowed
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(i != 0, ht.Insert(nullptr, i, 2 * i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(i == 0 ? 1 : 2, res.size());
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    res.clear();
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  ht.VerifyIntegrity();
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  // fewer frames than buckets, splits must leave their pages unpinned
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  uint32_t global_depth = ht.GetGlobalDepth();
+  EXPECT_GT(global_depth, 4);
+  ht.VerifyIntegrity();
+
+  std::vector<int> res;
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // emptied buckets merge with their images, the directory shrinks as they do
+  for (int i = 0; i < num_keys; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  for (int i = 1; i < num_keys; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_FALSE(ht.GetValue(nullptr, 1, &res));
+
+  // the table grows again
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, -i));
+  }
+  EXPECT_EQ(global_depth, ht.GetGlobalDepth());
+  ht.VerifyIntegrity();
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DuplicateKeyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the values of a single key fill several buckets, which a split cannot tell apart
+  const int num_values = 1000;
+  for (int i = 0; i < num_values; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, 7, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 7, 0));
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  ASSERT_TRUE(ht.GetValue(nullptr, 7, &res));
+  EXPECT_EQ(num_values, res.size());
+
+  // other keys still split the directory, the chain moves with the bucket of the key
+  const int num_keys = 2000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, -i - 1));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  ht.VerifyIntegrity();
+  res.clear();
+  ASSERT_TRUE(ht.GetValue(nullptr, 7, &res));
+  EXPECT_EQ(num_values + 1, res.size());
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i == 7 ? num_values + 1 : 1, res.size());
+  }
+
+  // the chain shrinks as its values go, then the buckets merge
+  for (int i = 0; i < num_values; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, 7, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, -i - 1));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 7, &res));
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // each thread inserts its own keys while looking up those it already inserted, then removes every other one
+  const int num_threads = 4;
+  const int keys_per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      std::vector<int> res;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + t;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+        res.clear();
+        int inserted_key = i / 2 * num_threads + t;
+        EXPECT_TRUE(ht.GetValue(nullptr, inserted_key, &res));
+      }
+      for (int i = 0; i < keys_per_thread; i += 2) {
+        int key = i * num_threads + t;
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  std::vector<int> res;
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    res.clear();
+    bool kept = key / num_threads % 2 == 1;
+    ASSERT_EQ(kept, ht.GetValue(nullptr, key, &res));
+    if (kept) {
+      EXPECT_EQ(key, res[0]);
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub
@@ -18,12 +18,15 @@
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_fingerprint_block_page.h"
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -61,7 +64,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -111,4 +114,158 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, FingerprintBlockPageTest) {
+  using KeyType = int;
+  using ValueType = int;
+  using BlockPage = HashTableFingerprintBlockPage<KeyType, ValueType, IntComparator>;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page = reinterpret_cast<BlockPage *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
+
+  // key i gets fingerprint i, a slot is only claimed once
+  auto fingerprint = [](unsigned i) { return BlockPage::Fingerprint(static_cast<uint64_t>(i) << 57); };
+  for (unsigned i = 0; i < 10; i++) {
+    EXPECT_TRUE(block_page->Insert(i, i, i, fingerprint(i)));
+  }
+  EXPECT_FALSE(block_page->Insert(3, 3, 3, fingerprint(3)));
+  for (unsigned i = 0; i < 10; i++) {
+    EXPECT_EQ(i, block_page->KeyAt(i));
+    EXPECT_EQ(i, block_page->ValueAt(i));
+  }
+
+  // a group matches the slots of a fingerprint and the free slots
+  uint32_t group_mask = BlockPage::GROUP_SIZE == 32 ? ~0U : (1U << BlockPage::GROUP_SIZE) - 1;
+  uint32_t empty;
+  EXPECT_EQ(1U << 3, block_page->MatchGroup(0, fingerprint(3), &empty));
+  EXPECT_EQ(group_mask & ~0x3ffU, empty);
+  EXPECT_EQ(1U << 1, block_page->MatchGroup(2, fingerprint(3), &empty));
+  EXPECT_EQ(0, block_page->MatchGroup(0, fingerprint(20), &empty));
+
+  // removed slots stay occupied, and no longer match
+  for (unsigned i = 1; i < 10; i += 2) {
+    block_page->Remove(i);
+  }
+  for (unsigned i = 0; i < 15; i++) {
+    EXPECT_EQ(i < 10, block_page->IsOccupied(i));
+    EXPECT_EQ(i < 10 && i % 2 == 0, block_page->IsReadable(i));
+  }
+  EXPECT_EQ(0, block_page->MatchGroup(0, fingerprint(3), &empty));
+  EXPECT_EQ(group_mask & ~0x3ffU, empty);
+
+  // a group is cut short at the end of the block
+  slot_offset_t last = FINGERPRINT_BLOCK_ARRAY_SIZE - 1;
+  EXPECT_TRUE(block_page->Insert(last, 7, 7, fingerprint(7)));
+  EXPECT_EQ(1U << 2, block_page->MatchGroup(last - 2, fingerprint(7), &empty));
+  EXPECT_EQ(0x3U, empty);
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, DirectoryPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  auto directory_page =
+      reinterpret_cast<HashTableDirectoryPage *>(bpm->NewPage(&directory_page_id, nullptr)->GetData());
+  directory_page->Init(directory_page_id, 10);
+  EXPECT_EQ(directory_page_id, directory_page->GetPageId());
+  EXPECT_EQ(0, directory_page->GetGlobalDepth());
+  EXPECT_EQ(1, directory_page->Size());
+  EXPECT_FALSE(directory_page->CanShrink());
+
+  // split bucket 10 into 10 and 11, then 10 again into 10 and 12
+  directory_page->IncrGlobalDepth();
+  directory_page->SetLocalDepth(0, 1);
+  directory_page->SetLocalDepth(1, 1);
+  directory_page->SetBucketPageId(1, 11);
+  directory_page->VerifyIntegrity();
+  EXPECT_EQ(0, directory_page->GetSplitImageIndex(1));
+  directory_page->IncrGlobalDepth();
+  EXPECT_EQ(4, directory_page->Size());
+  EXPECT_EQ(3, directory_page->GetGlobalDepthMask());
+  EXPECT_EQ(11, directory_page->GetBucketPageId(3));
+  EXPECT_EQ(1, directory_page->GetLocalDepth(3));
+  directory_page->SetLocalDepth(0, 2);
+  directory_page->SetLocalDepth(2, 2);
+  directory_page->SetBucketPageId(2, 12);
+  directory_page->VerifyIntegrity();
+  EXPECT_EQ(0, directory_page->GetSplitImageIndex(2));
+  EXPECT_EQ(1, directory_page->GetLocalDepthMask(1));
+  EXPECT_FALSE(directory_page->CanShrink());
+
+  // merge them back
+  directory_page->SetBucketPageId(2, 10);
+  directory_page->SetLocalDepth(0, 1);
+  directory_page->SetLocalDepth(2, 1);
+  ASSERT_TRUE(directory_page->CanShrink());
+  directory_page->DecrGlobalDepth();
+  directory_page->VerifyIntegrity();
+  EXPECT_EQ(2, directory_page->Size());
+
+  bpm->UnpinPage(directory_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  bucket_page->Init();
+  IntComparator comparator;
+
+  // insert a few (key, value) pairs, a pair only once
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(bucket_page->Insert(i, i, comparator));
+  }
+  EXPECT_FALSE(bucket_page->Insert(1, 1, comparator));
+  EXPECT_TRUE(bucket_page->Insert(1, 2, comparator));
+  std::vector<int> res;
+  EXPECT_TRUE(bucket_page->GetValue(1, comparator, &res));
+  EXPECT_EQ(2, res.size());
+
+  // removed slots stay occupied and are taken again first
+  for (int i = 0; i < 10; i += 2) {
+    EXPECT_TRUE(bucket_page->Remove(i, i, comparator));
+  }
+  EXPECT_FALSE(bucket_page->Remove(0, 0, comparator));
+  EXPECT_EQ(6, bucket_page->NumReadable());
+  for (slot_offset_t i = 0; i < 12; i++) {
+    EXPECT_EQ(i < 11, bucket_page->IsOccupied(i));
+    // slot 10 holds (1, 2)
+    EXPECT_EQ(i < 11 && (i % 2 == 1 || i == 10), bucket_page->IsReadable(i)) << i;
+  }
+  EXPECT_TRUE(bucket_page->Insert(20, 20, comparator));
+  EXPECT_TRUE(bucket_page->IsReadable(0));
+  EXPECT_EQ(20, bucket_page->KeyAt(0));
+
+  // fill it up
+  for (int i = 100; !bucket_page->IsFull(); i++) {
+    ASSERT_TRUE(bucket_page->Insert(i, i, comparator));
+  }
+  EXPECT_FALSE(bucket_page->Insert(-1, -1, comparator));
+  EXPECT_FALSE(bucket_page->IsEmpty());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -10,7 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <set>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "common/logger.h"
@@ -21,7 +28,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -104,4 +111,289 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // a single block to begin with
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // the table grows as it fills, pairs stay visible while they are moved to the new blocks
+  const int num_keys = 20000;
+  std::vector<int> res;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    if (i % 1000 == 0) {
+      for (int j = 0; j <= i; j += 7) {
+        res.clear();
+        ASSERT_TRUE(ht.GetValue(nullptr, j, &res)) << j;
+        ASSERT_EQ(1, res.size());
+      }
+    }
+  }
+  size_t grown_size = ht.GetSize();
+  EXPECT_GE(grown_size, num_keys);
+  EXPECT_GT(grown_size, initial_size);
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+
+  // churn leaves tombstones, which a rehash sheds without growing the table further
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      ASSERT_TRUE(ht.Remove(nullptr, i, i + round));
+      ASSERT_TRUE(ht.Insert(nullptr, i, i + round + 1));
+    }
+  }
+  EXPECT_LE(ht.GetSize(), 2 * grown_size);
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i + 4, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeOverflowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // a resize to a single block, which fills up before the pairs of the old blocks are all moved to it
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 2000, HashFunction<int>());
+  const int num_keys = 1000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.Resize(1);
+  ASSERT_LT(ht.GetSize(), num_keys);
+
+  // lookups move blocks until the new table is full, the pairs that do not fit stay where they were
+  std::vector<int> res;
+  for (int i = 0; i < num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res)) << i;
+    ASSERT_EQ(1, res.size());
+  }
+
+  // the next insert finds the new table full and merges both into a larger one
+  ASSERT_TRUE(ht.Insert(nullptr, num_keys, num_keys));
+  EXPECT_GE(ht.GetSize(), num_keys + 1);
+  for (int i = 0; i <= num_keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res)) << i;
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // each thread inserts its own keys while looking up those it already inserted, then removes every other one
+  const int num_threads = 4;
+  const int keys_per_thread = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      std::vector<int> res;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + t;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+        res.clear();
+        int inserted_key = i / 2 * num_threads + t;
+        EXPECT_TRUE(ht.GetValue(nullptr, inserted_key, &res));
+        EXPECT_EQ(1, res.size());
+      }
+      for (int i = 0; i < keys_per_thread; i += 2) {
+        int key = i * num_threads + t;
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<int> res;
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    res.clear();
+    bool kept = key / num_threads % 2 == 1;
+    ASSERT_EQ(kept, ht.GetValue(nullptr, key, &res));
+    if (kept) {
+      EXPECT_EQ(key, res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentDuplicateInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // every thread inserts the same pairs, each of which goes in once, while the table grows
+  for (bool fingerprints : {true, false}) {
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>(),
+                                                     fingerprints);
+    const int num_threads = 4;
+    const int num_keys = 10000;
+    std::vector<std::atomic<int>> num_inserted(num_keys);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&] {
+        for (int key = 0; key < num_keys; key++) {
+          if (ht.Insert(nullptr, key, key)) {
+            num_inserted[key]++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<int> res;
+    for (int key = 0; key < num_keys; key++) {
+      ASSERT_EQ(1, num_inserted[key]) << key;
+      res.clear();
+      ASSERT_TRUE(ht.GetValue(nullptr, key, &res));
+      ASSERT_EQ(1, res.size()) << key;
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, LayoutTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // the same random operations on a table of either block layout, which grows and rehashes on the way
+  LinearProbeHashTable<int, int, IntComparator> fingerprint_ht("blah", bpm, IntComparator(), 10, HashFunction<int>(),
+                                                               true);
+  LinearProbeHashTable<int, int, IntComparator> bitmap_ht("blah", bpm, IntComparator(), 10, HashFunction<int>(), false);
+  std::set<std::pair<int, int>> expected;
+  std::mt19937 rng(15445);
+  const int num_keys = 3000;
+  std::vector<int> res;
+  for (int i = 0; i < 60000; i++) {
+    int key = rng() % num_keys;
+    int value = rng() % 4;
+    if (rng() % 3 != 0) {
+      bool inserted = expected.emplace(key, value).second;
+      ASSERT_EQ(inserted, fingerprint_ht.Insert(nullptr, key, value));
+      ASSERT_EQ(inserted, bitmap_ht.Insert(nullptr, key, value));
+    } else {
+      bool removed = expected.erase({key, value}) == 1;
+      ASSERT_EQ(removed, fingerprint_ht.Remove(nullptr, key, value));
+      ASSERT_EQ(removed, bitmap_ht.Remove(nullptr, key, value));
+    }
+
+    if (i % 10000 == 9999) {
+      for (key = 0; key < num_keys; key++) {
+        std::vector<int> values;
+        for (auto it = expected.lower_bound({key, 0}); it != expected.end() && it->first == key; ++it) {
+          values.push_back(it->second);
+        }
+        for (auto *ht : {&fingerprint_ht, &bitmap_ht}) {
+          res.clear();
+          ASSERT_EQ(!values.empty(), ht->GetValue(nullptr, key, &res));
+          std::sort(res.begin(), res.end());
+          ASSERT_EQ(values, res) << key;
+        }
+      }
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+/*
+ * Compares the two block layouts on the same workload, a table sized to hold every key without a resize. Build
+ * with optimizations, the intrinsics of the fingerprint layout are not inlined otherwise:
+ *   make hash_table_test && ./test/hash_table_test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*
+ */
+// NOLINTNEXTLINE
+TEST(HashTableTest, DISABLED_LayoutBenchmarkTest) {
+  const int num_keys = 200000;
+  std::vector<int> keys(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::default_random_engine(0));
+
+  for (bool fingerprints : {false, true}) {
+    remove("test.db");
+    auto *disk_manager = new DiskManager("test.db");
+    // every block stays in the buffer pool
+    auto *bpm = new BufferPoolManager(2000, disk_manager);
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 2 * num_keys, HashFunction<int>(),
+                                                     fingerprints);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int key : keys) {
+      ASSERT_TRUE(ht.Insert(nullptr, key, key));
+    }
+    double insert_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int> res;
+    start = std::chrono::steady_clock::now();
+    for (int key : keys) {
+      res.clear();
+      ASSERT_TRUE(ht.GetValue(nullptr, key, &res));
+    }
+    double hit_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int key : keys) {
+      res.clear();
+      ASSERT_FALSE(ht.GetValue(nullptr, key + num_keys, &res));
+    }
+    double miss_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%s blocks, %zu slots\n", fingerprints ? "fingerprint" : "bitmap", ht.GetSize());
+    printf("  insert:       %.0f ops/s\n", num_keys / insert_seconds);
+    printf("  lookup hit:   %.0f ops/s\n", num_keys / hit_seconds);
+    printf("  lookup miss:  %.0f ops/s\n", num_keys / miss_seconds);
+
+    disk_manager->ShutDown();
+    delete bpm;
+    delete disk_manager;
+  }
+  remove("test.db");
+}
+
 }  // namespace bustub
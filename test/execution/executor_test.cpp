@@ -26,12 +26,14 @@
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/index_only_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_only_scan_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
@@ -546,4 +548,58 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexOnlyScanTest) {
+  // SELECT colA, colD FROM test_1 WHERE colA >= 100 AND colA < 600 AND colB < 5, from an index on colA that
+  // includes colB and colD
+
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto *catalog = GetExecutorContext()->GetCatalog();
+  auto index_info = catalog->CreateIndex<GenericKey<8>, CoveringValue<8>, GenericComparator<8>>(
+      GetTxn(), "test_1_colA", "test_1", table_info->schema_, *key_schema, {0}, 8, true, {1, 3});
+  const Schema &covered_schema = *index_info->index_->GetMetadata()->GetCoveredSchema();
+  ASSERT_EQ(3, covered_schema.GetColumnCount());
+
+  auto *colA = MakeColumnValueExpression(covered_schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(covered_schema, 0, "colB");
+  auto *colD = MakeColumnValueExpression(covered_schema, 0, "colD");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(colB, const5, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colD", colD}});
+  Tuple low_key({ValueFactory::GetIntegerValue(100)}, key_schema);
+  Tuple high_key({ValueFactory::GetIntegerValue(600)}, key_schema);
+  IndexOnlyScanPlanNode plan{out_schema, predicate, index_info->index_oid_, &low_key, &high_key};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // the rows come in key order, with the values the table has
+  auto &schema = table_info->schema_;
+  size_t expected = 0;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    int32_t a = it->GetValue(&schema, schema.GetColIdx("colA")).GetAs<int32_t>();
+    expected += a >= 100 && a < 600 && it->GetValue(&schema, schema.GetColIdx("colB")).GetAs<int32_t>() < 5;
+  }
+  ASSERT_EQ(expected, result_set.size());
+  int32_t previous = 99;
+  std::vector<RID> rids;
+  for (const auto &tuple : result_set) {
+    int32_t a = tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_GT(a, previous);
+    ASSERT_LT(a, 600);
+    previous = a;
+
+    rids.clear();
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(a)}, key_schema), &rids, GetTxn());
+    ASSERT_EQ(1, rids.size());
+    Tuple table_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[0], &table_tuple, GetTxn()));
+    ASSERT_LT(table_tuple.GetValue(&schema, schema.GetColIdx("colB")).GetAs<int32_t>(), 5);
+    ASSERT_EQ(table_tuple.GetValue(&schema, schema.GetColIdx("colD")).GetAs<int32_t>(),
+              tuple.GetValue(out_schema, out_schema->GetColIdx("colD")).GetAs<int32_t>());
+  }
+  delete key_schema;
+}
+
 }  // namespace bustub
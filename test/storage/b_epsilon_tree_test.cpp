@@ -0,0 +1,221 @@
+/**
+ * b_epsilon_tree_test.cpp
+ */
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_epsilon_tree.h"
+#include "storage/index/b_epsilon_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BEpsilonTreeTests, MessageTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // enough keys for the root leaf to split, later messages wait in the buffer of the new root
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 10; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+
+  std::vector<RID> rids;
+  index_key.SetFromInteger(3);
+  tree.Insert(index_key, RID(1, 1));
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(RID(0, 3), rids[0]);
+
+  tree.Upsert(index_key, RID(2, 2));
+  rids.clear();
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(RID(2, 2), rids[0]);
+
+  tree.Remove(index_key);
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  EXPECT_TRUE(rids.empty());
+
+  // a key that only exists as a message, inserted after its removal
+  index_key.SetFromInteger(100);
+  tree.Remove(index_key);
+  tree.Insert(index_key, RID(3, 3));
+  ASSERT_TRUE(tree.GetValue(index_key, &rids));
+  EXPECT_EQ(RID(3, 3), rids[0]);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BEpsilonTreeTests, RandomOperationTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // small pages, so that messages are flushed through several levels
+  BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 4);
+
+  std::mt19937 rng(15445);
+  std::map<int64_t, RID> expected;
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  const int64_t num_keys = 3000;
+  for (int i = 0; i < 60000; i++) {
+    int64_t key = rng() % num_keys;
+    RID rid(i, key);
+    index_key.SetFromInteger(key);
+    switch (rng() % 4) {
+      case 0:
+      case 1:
+        tree.Insert(index_key, rid);
+        expected.emplace(key, rid);
+        break;
+      case 2:
+        tree.Upsert(index_key, rid);
+        expected[key] = rid;
+        break;
+      default:
+        tree.Remove(index_key);
+        expected.erase(key);
+        break;
+    }
+
+    if (i % 10000 == 9999) {
+      for (key = 0; key < num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        auto it = expected.find(key);
+        ASSERT_EQ(it != expected.end(), tree.GetValue(index_key, &rids));
+        if (it != expected.end()) {
+          ASSERT_EQ(it->second, rids[0]);
+        }
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BEpsilonTreeTests, ConcurrentTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BEpsilonTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 16, 8);
+
+  // each thread inserts its own keys while looking up those it already inserted
+  const int num_threads = 4;
+  const int64_t keys_per_thread = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int64_t i = 0; i < keys_per_thread; i++) {
+        index_key.SetFromInteger(i * num_threads + t);
+        tree.Insert(index_key, RID(t, i));
+        index_key.SetFromInteger(i / 2 * num_threads + t);
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (int t = 0; t < num_threads; t++) {
+    for (int64_t i = 0; i < keys_per_thread; i++) {
+      rids.clear();
+      index_key.SetFromInteger(i * num_threads + t);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(RID(t, i), rids[0]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BEpsilonTreeTests, IndexTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *metadata = new IndexMetadata("foo_pk", "foo", &schema, {0});
+  BEpsilonTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata, bpm);
+
+  Transaction transaction(0);
+  const int64_t num_keys = 2000;
+  for (int64_t key = 0; key < num_keys; key++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, metadata->GetKeySchema());
+    index.InsertEntry(tuple, RID(0, key), &transaction);
+  }
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, metadata->GetKeySchema());
+    index.DeleteEntry(tuple, RID(0, key), &transaction);
+  }
+  Tuple moved({ValueFactory::GetBigIntValue(1)}, metadata->GetKeySchema());
+  index.UpsertEntry(moved, RID(1, 1), &transaction);
+
+  std::vector<RID> result;
+  for (int64_t key = 0; key < num_keys; key++) {
+    result.clear();
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, metadata->GetKeySchema());
+    index.ScanKey(tuple, &result, &transaction);
+    ASSERT_EQ(key % 2, result.size());
+    if (key % 2 == 1) {
+      EXPECT_EQ(key == 1 ? RID(1, 1) : RID(0, key), result[0]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -3,7 +3,14 @@
  */
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
@@ -12,7 +19,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   std::string createStmt = "a bigint";
   Schema *key_schema = ParseCreateStatement(createStmt);
@@ -92,7 +99,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -170,4 +177,223 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, RangeIteratorTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  for (bool b_link : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 4, b_link);
+    GenericKey<8> index_key;
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // reverse scans step from leaf to leaf by key, negative keys make sure they stop at the first leaf
+    const int64_t scale_factor = 1000;
+    std::vector<int64_t> keys(scale_factor);
+    std::iota(keys.begin(), keys.end(), -scale_factor / 2);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key));
+    }
+    for (auto key : keys) {
+      if (key % 3 == 0) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+    }
+    std::vector<int64_t> remaining;
+    std::copy_if(keys.begin(), keys.end(), std::back_inserter(remaining), [](int64_t key) { return key % 3 != 0; });
+    std::sort(remaining.begin(), remaining.end());
+
+    auto scan = [](auto iterator) {
+      std::vector<int64_t> result;
+      for (; !iterator.isEnd(); ++iterator) {
+        result.push_back((*iterator).first.ToString());
+      }
+      return result;
+    };
+    std::vector<int64_t> expected(remaining.rbegin(), remaining.rend());
+    EXPECT_EQ(scan(tree.rbegin()), expected);
+
+    GenericKey<8> low_key;
+    GenericKey<8> high_key;
+    for (auto [low, high] : {std::pair<int64_t, int64_t>{-scale_factor, -400}, {0, scale_factor}, {100, 200},
+                             {301, 303}, {3, 4}, {300, 200}, {-10, 7}, {scale_factor / 2 - 5, scale_factor}}) {
+      low_key.SetFromInteger(low);
+      high_key.SetFromInteger(high);
+      expected.clear();
+      std::copy_if(remaining.begin(), remaining.end(), std::back_inserter(expected),
+                   [&](int64_t key) { return key >= low && key < high; });
+      EXPECT_EQ(scan(tree.Range(low_key, high_key)), expected);
+      std::reverse(expected.begin(), expected.end());
+      EXPECT_EQ(scan(tree.Range(low_key, high_key, true)), expected);
+    }
+
+    // batches never span two leaves, but together return every pair
+    std::vector<std::pair<GenericKey<8>, RID>> batch;
+    auto iterator = tree.begin();
+    int num_batches = 0;
+    while (iterator.NextBatch(&batch, 3) > 0) {
+      num_batches++;
+    }
+    EXPECT_GE(num_batches, static_cast<int>(remaining.size()) / 4);
+    ASSERT_EQ(batch.size(), remaining.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      EXPECT_EQ(batch[i].first.ToString(), remaining[i]);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, CompactionTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // leaves only underflow below a quarter full
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8, false, false, true, 0.25);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  auto count_leaves = [&]() {
+    Page *page = tree.FindLeafPage(index_key, true);
+    page->RUnlatch();
+    int num_leaves = 1;
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    while (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+      auto *next = reinterpret_cast<LeafPage *>(bpm->FetchPage(leaf->GetNextPageId())->GetData());
+      bpm->UnpinPage(leaf->GetPageId(), false);
+      leaf = next;
+      num_leaves++;
+    }
+    bpm->UnpinPage(leaf->GetPageId(), false);
+    return num_leaves;
+  };
+  auto check_keys = [&](int64_t step) {
+    int64_t expected = 0;
+    for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator, expected += step) {
+      ASSERT_EQ((*iterator).first.ToString(), expected);
+    }
+  };
+
+  // leaves hold at least four pairs after the insertions and at least two after removing every other key, so the
+  // removals never merge anything
+  const int64_t scale_factor = 1000;
+  for (int64_t key = 0; key < scale_factor; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+  int num_leaves = count_leaves();
+  for (int64_t key = 1; key < scale_factor; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_EQ(count_leaves(), num_leaves);
+  check_keys(2);
+
+  // compaction merges the leaves below half full, and leaves the keys as they are
+  int merged = tree.Compact();
+  EXPECT_GT(merged, 0);
+  EXPECT_EQ(count_leaves(), num_leaves - merged);
+  check_keys(2);
+  EXPECT_EQ(tree.Compact(), 0);
+
+  // the background thread does the same once the tree is idle
+  for (int64_t key = 2; key < scale_factor; key += 4) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  num_leaves = count_leaves();
+  compaction_interval = std::chrono::milliseconds(10);
+  tree.StartCompaction();
+  for (int i = 0; i < 100 && count_leaves() == num_leaves; i++) {
+    std::this_thread::sleep_for(compaction_interval);
+  }
+  tree.StopCompaction();
+  EXPECT_LT(count_leaves(), num_leaves);
+  check_keys(4);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, FreedPageTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // no top levels are pinned, so no snapshot retries the deletes
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (int64_t key = 1; key <= 10; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+
+  // a reader keeps the last leaf pinned while its keys are removed and the leaf is merged away
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  index_key.SetFromInteger(10);
+  Page *page = tree.FindLeafPage(index_key);
+  page->RUnlatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t leaf_page_id = leaf->GetPageId();
+  std::vector<GenericKey<8>> leaf_keys;
+  for (int i = 0; i < leaf->GetSize(); i++) {
+    leaf_keys.push_back(leaf->KeyAt(i));
+  }
+  for (const auto &key : leaf_keys) {
+    tree.Remove(key);
+  }
+  bpm->UnpinPage(leaf_page_id, false);
+
+  // the next removal deletes the leaf, which leaves the buffer pool
+  auto in_pool = [&](page_id_t page_id) {
+    Page *pages = bpm->GetPages();
+    return std::any_of(pages, pages + bpm->GetPoolSize(), [page_id](Page &p) { return p.GetPageId() == page_id; });
+  };
+  EXPECT_TRUE(in_pool(leaf_page_id));
+  index_key.SetFromInteger(1);
+  tree.Remove(index_key);
+  EXPECT_FALSE(in_pool(leaf_page_id));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <vector>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
@@ -12,7 +14,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -71,7 +73,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -139,4 +141,288 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+  for (bool b_link : {false, true}) {
+    for (double fill_factor : {0.5, 1.0}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 9, 6, b_link);
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // even keys only, with every hundredth one repeated
+      const int64_t scale_factor = 10000;
+      int64_t next_key = 0;
+      bool repeated = false;
+      auto next = [&](GenericKey<8> *key, RID *rid) {
+        if (next_key >= scale_factor) {
+          return false;
+        }
+        key->SetFromInteger(next_key);
+        rid->Set(0, next_key);
+        if (next_key % 100 == 0 && !repeated) {
+          repeated = true;
+        } else {
+          repeated = false;
+          next_key += 2;
+        }
+        return true;
+      };
+      ASSERT_TRUE(tree.BulkLoad(next, fill_factor));
+      EXPECT_FALSE(tree.BulkLoad(next, fill_factor));
+
+      // leaves are packed to the fill factor and laid out one after another
+      int leaf_fill = static_cast<int>(fill_factor * 8);
+      Page *page = tree.FindLeafPage(GenericKey<8>(), true);
+      page->RUnlatch();
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      int num_leaves = 1;
+      while (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+        EXPECT_EQ(leaf->GetNextPageId(), leaf->GetPageId() + 1);
+        if (num_leaves < (scale_factor / 2) / leaf_fill - 1) {
+          EXPECT_EQ(leaf->GetSize(), leaf_fill);
+        }
+        EXPECT_GE(leaf->GetSize(), leaf->GetMinSize());
+        page_id_t next_page_id = leaf->GetNextPageId();
+        bpm->UnpinPage(leaf->GetPageId(), false);
+        leaf = reinterpret_cast<LeafPage *>(bpm->FetchPage(next_page_id)->GetData());
+        num_leaves++;
+      }
+      EXPECT_GE(leaf->GetSize(), leaf->GetMinSize());
+      bpm->UnpinPage(leaf->GetPageId(), false);
+      EXPECT_EQ(num_leaves, (scale_factor / 2 + leaf_fill - 1) / leaf_fill);
+
+      std::vector<RID> rids;
+      GenericKey<8> index_key;
+      for (int64_t key = 0; key < scale_factor; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 0);
+      }
+
+      // the loaded tree takes ordinary insertions and removals
+      for (int64_t key = 1; key < scale_factor; key += 2) {
+        index_key.SetFromInteger(key);
+        RID rid(0, key);
+        EXPECT_TRUE(tree.Insert(index_key, rid));
+      }
+      for (int64_t key = 0; key < scale_factor; key += 4) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      int64_t current_key = 1;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        if (current_key % 4 == 0) {
+          current_key++;
+        }
+        EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+        current_key++;
+      }
+      EXPECT_EQ(current_key, scale_factor);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, NonUniqueTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  // key k has k % 10 + 1 values, kept in the leaf up to four of them; the hot key spans several posting pages
+  const int64_t num_keys = 200;
+  const int64_t hot_key = 100;
+  const int64_t hot_values = 3 * POSTING_PAGE_SIZE;
+  auto num_values = [&](int64_t key) { return key == hot_key ? hot_values : key % 10 + 1; };
+  std::vector<std::pair<int64_t, int64_t>> pairs;
+  for (int64_t key = 0; key < num_keys; key++) {
+    for (int64_t slot = 0; slot < num_values(key); slot++) {
+      pairs.emplace_back(key, slot);
+    }
+  }
+
+  for (bool b_link : {false, true}) {
+    for (bool bulk_load : {false, true}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 33, 6, b_link, false, false);
+      GenericKey<8> index_key;
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      if (bulk_load) {
+        auto pair = pairs.begin();
+        auto next = [&](GenericKey<8> *key, RID *rid) {
+          if (pair == pairs.end()) {
+            return false;
+          }
+          key->SetFromInteger(pair->first);
+          rid->Set(0, pair->second);
+          ++pair;
+          return true;
+        };
+        ASSERT_TRUE(tree.BulkLoad(next, 0.5));
+      } else {
+        std::vector<std::pair<int64_t, int64_t>> shuffled = pairs;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+        for (const auto &[key, slot] : shuffled) {
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.Insert(index_key, RID(0, slot)));
+        }
+      }
+      index_key.SetFromInteger(hot_key);
+      EXPECT_FALSE(tree.Insert(index_key, RID(0, 7)));
+      index_key.SetFromInteger(3);
+      EXPECT_FALSE(tree.Insert(index_key, RID(0, 2)));
+
+      // every value of a key comes back in order, from the leaf or the posting list
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(rids.size(), num_values(key));
+        for (int64_t slot = 0; slot < num_values(key); slot++) {
+          EXPECT_EQ(rids[slot].GetSlotNum(), slot);
+        }
+      }
+
+      // the iterator returns each pair of a posting list on its own
+      auto expected = pairs.begin();
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator, ++expected) {
+        ASSERT_NE(expected, pairs.end());
+        EXPECT_EQ((*iterator).first.ToString(), expected->first);
+        EXPECT_EQ((*iterator).second.GetSlotNum(), expected->second);
+      }
+      EXPECT_EQ(expected, pairs.end());
+      auto reverse_expected = pairs.rbegin();
+      for (auto iterator = tree.rbegin(); iterator != tree.end(); ++iterator, ++reverse_expected) {
+        ASSERT_NE(reverse_expected, pairs.rend());
+        EXPECT_EQ((*iterator).first.ToString(), reverse_expected->first);
+        EXPECT_EQ((*iterator).second.GetSlotNum(), reverse_expected->second);
+      }
+      EXPECT_EQ(reverse_expected, pairs.rend());
+
+      // removing single pairs keeps the other values of the key, removing the key drops all of them
+      for (int64_t key = 0; key < num_keys; key++) {
+        index_key.SetFromInteger(key);
+        if (key % 3 == 0) {
+          tree.Remove(index_key);
+          continue;
+        }
+        for (int64_t slot = 0; slot < num_values(key); slot += 2) {
+          tree.Remove(index_key, RID(0, slot));
+        }
+        tree.Remove(index_key, RID(0, num_values(key)));
+      }
+      for (int64_t key = 0; key < num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        int64_t remaining = key % 3 == 0 ? 0 : num_values(key) / 2;
+        EXPECT_EQ(tree.GetValue(index_key, &rids), remaining > 0);
+        ASSERT_EQ(rids.size(), remaining);
+        for (int64_t i = 0; i < remaining; i++) {
+          EXPECT_EQ(rids[i].GetSlotNum(), 2 * i + 1);
+        }
+      }
+
+      // a posting list goes back into the leaf when a single value is left
+      index_key.SetFromInteger(19);
+      for (int64_t slot = 1; slot < 9; slot += 2) {
+        tree.Remove(index_key, RID(0, slot));
+      }
+      rids.clear();
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), 9);
+      tree.Remove(index_key, RID(0, 9));
+      EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, GetValuesTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  for (bool b_link : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 4, b_link);
+    GenericKey<8> index_key;
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // only the even keys are in the tree
+    const int64_t scale_factor = 2000;
+    for (int64_t key = 0; key < scale_factor; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key));
+    }
+
+    // dense batches stay in a leaf or move on to the next one, sparse ones descend again; a key may repeat
+    for (int64_t step : {int64_t{1}, int64_t{3}, int64_t{97}, scale_factor}) {
+      std::vector<int64_t> probes;
+      for (int64_t key = -1; key <= scale_factor; key += step) {
+        probes.push_back(key);
+        if (key == 500) {
+          probes.push_back(key);
+        }
+      }
+      std::vector<GenericKey<8>> keys(probes.size());
+      for (size_t i = 0; i < probes.size(); i++) {
+        keys[i].SetFromInteger(probes[i]);
+      }
+      std::vector<std::vector<RID>> results;
+      int found = tree.GetValues(keys, &results);
+
+      ASSERT_EQ(results.size(), probes.size());
+      int expected_found = 0;
+      for (size_t i = 0; i < probes.size(); i++) {
+        bool present = probes[i] >= 0 && probes[i] < scale_factor && probes[i] % 2 == 0;
+        expected_found += present ? 1 : 0;
+        ASSERT_EQ(results[i].size(), present ? 1 : 0);
+        if (present) {
+          EXPECT_EQ(results[i][0].GetSlotNum(), probes[i]);
+        }
+      }
+      EXPECT_EQ(found, expected_found);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
 }  // namespace bustub
@@ -11,10 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <filesystem>
+#include <random>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/page_compressor.h"
 
 namespace bustub {
 
@@ -72,6 +75,100 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PageCompressorRoundTripTest) {
+  char page[PAGE_SIZE] = {0};
+  char compressed[PAGE_SIZE];
+  char out[PAGE_SIZE];
+
+  // a sparse page compresses well
+  for (int i = 0; i < PAGE_SIZE / 4; i++) {
+    page[i] = static_cast<char>(i % 7);
+  }
+  size_t size = PageCompressor::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  ASSERT_NE(0, size);
+  EXPECT_LT(size, PAGE_SIZE / 4);
+  ASSERT_TRUE(PageCompressor::Decompress(compressed, size, out, PAGE_SIZE));
+  EXPECT_EQ(0, std::memcmp(page, out, PAGE_SIZE));
+
+  // random bytes do not fit in less than a page
+  std::mt19937 rng(15445);
+  for (char &c : page) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_EQ(0, PageCompressor::Compress(page, PAGE_SIZE, compressed, PAGE_SIZE - 1));
+
+  // truncated input is rejected
+  std::memset(page, 'x', PAGE_SIZE);
+  size = PageCompressor::Compress(page, PAGE_SIZE, compressed, sizeof(compressed));
+  ASSERT_NE(0, size);
+  EXPECT_FALSE(PageCompressor::Decompress(compressed, size / 2, out, PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressedReadWritePageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  char noise[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::mt19937 rng(15445);
+  for (char &c : noise) {
+    c = static_cast<char>(rng());
+  }
+
+  {
+    auto dm = DiskManager(db_file, true);
+    EXPECT_TRUE(dm.IsCompressed());
+    std::strncpy(data, "A test string.", sizeof(data));
+
+    dm.ReadPage(0, buf);  // tolerate empty read
+
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      data[PAGE_SIZE - 1] = static_cast<char>(page_id);
+      dm.WritePage(page_id, data);
+    }
+    // compressed images are much smaller than the raw pages
+    EXPECT_LT(dm.GetNumBytesWritten(), 8 * PAGE_SIZE / 4);
+
+    // an incompressible page is relocated into a bigger slot
+    dm.WritePage(3, noise);
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(std::memcmp(buf, noise, sizeof(buf)), 0);
+
+    data[PAGE_SIZE - 1] = 5;
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+
+  // the indirection map is rebuilt from the slot headers
+  {
+    auto dm = DiskManager(db_file, true);
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      dm.ReadPage(page_id, buf);
+      if (page_id == 3) {
+        EXPECT_EQ(std::memcmp(buf, noise, sizeof(buf)), 0);
+      } else {
+        data[PAGE_SIZE - 1] = static_cast<char>(page_id);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    }
+
+    // the slot page 3 left behind is reused, the file does not grow. Page 10 takes the slot freed when page 3 was
+    // relocated first, if it fits there
+    data[PAGE_SIZE - 1] = 10;
+    dm.WritePage(10, data);
+    auto file_size = std::filesystem::file_size(db_file);
+    dm.DeallocatePage(3);
+    data[PAGE_SIZE - 1] = 9;
+    dm.WritePage(9, data);
+    EXPECT_EQ(file_size, std::filesystem::file_size(db_file));
+    dm.ReadPage(9, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, MergeAdjacentWritesTest) {
+  DiskManager dm("test.db");
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  {
+    DiskScheduler scheduler(&dm);
+    scheduler.Pause();
+    std::vector<std::future<void>> writes;
+    // out of order and with a gap: 0..7 become one I/O and 10 another
+    for (page_id_t page_id : {3, 1, 0, 2, 10, 7, 5, 6, 4}) {
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      writes.push_back(scheduler.ScheduleWrite(page_id, data, IOPriority::BACKGROUND_FLUSH));
+    }
+    scheduler.Resume();
+    for (auto &write : writes) {
+      write.wait();
+    }
+    EXPECT_EQ(2, scheduler.GetNumDiskIOs());
+    EXPECT_EQ(9, scheduler.GetNumRequests(IOPriority::BACKGROUND_FLUSH));
+
+    scheduler.Pause();
+    std::vector<std::vector<char>> pages(8, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<void>> reads;
+    for (page_id_t page_id = 7; page_id >= 0; page_id--) {
+      reads.push_back(scheduler.ScheduleRead(page_id, pages[page_id].data(), IOPriority::PREFETCH));
+    }
+    scheduler.Resume();
+    for (auto &read : reads) {
+      read.wait();
+    }
+    EXPECT_EQ(3, scheduler.GetNumDiskIOs());
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      EXPECT_EQ(0, memcmp(pages[page_id].data(), data, PAGE_SIZE));
+    }
+  }
+
+  dm.ReadPage(10, buf);
+  memset(data, 'a' + 10, PAGE_SIZE);
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ReadForwardsQueuedWriteTest) {
+  DiskManager dm("test.db");
+  DiskScheduler scheduler(&dm);
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+
+  scheduler.Pause();
+  memset(data, 'x', PAGE_SIZE);
+  auto first = scheduler.ScheduleWrite(0, data, IOPriority::BACKGROUND_FLUSH);
+  memset(data, 'y', PAGE_SIZE);
+  auto second = scheduler.ScheduleWrite(0, data, IOPriority::FOREGROUND_WRITE);
+
+  // the read is answered while the write is still queued, with the newest image
+  auto read = scheduler.ScheduleRead(0, buf);
+  EXPECT_EQ(std::future_status::ready, read.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+
+  scheduler.Resume();
+  first.wait();
+  second.wait();
+  // both writes were absorbed into a single I/O
+  EXPECT_EQ(1, scheduler.GetNumDiskIOs());
+
+  // deallocating drops a queued write
+  scheduler.Pause();
+  auto dropped = scheduler.ScheduleWrite(1, data, IOPriority::BACKGROUND_FLUSH);
+  scheduler.DeallocatePage(1);
+  EXPECT_EQ(std::future_status::ready, dropped.wait_for(std::chrono::seconds(0)));
+  scheduler.Resume();
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ForegroundNotStarvedTest) {
+  DiskManager dm("test.db");
+  DiskScheduler scheduler(&dm);
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE];
+
+  // two background pages per second, on pages that cannot be merged
+  scheduler.SetRateLimit(IOPriority::BACKGROUND_FLUSH, 2);
+  scheduler.Pause();
+  std::vector<std::future<void>> flushes;
+  for (page_id_t page_id : {0, 2, 4}) {
+    flushes.push_back(scheduler.ScheduleWrite(page_id, data, IOPriority::BACKGROUND_FLUSH));
+  }
+  auto read = scheduler.ScheduleRead(20, buf);
+  scheduler.Resume();
+
+  // the foreground read goes first and is not held back by the throttled flushes
+  ASSERT_EQ(std::future_status::ready, read.wait_for(std::chrono::seconds(1)));
+  EXPECT_EQ(std::future_status::timeout, flushes.back().wait_for(std::chrono::seconds(0)));
+  for (auto &flush : flushes) {
+    flush.wait();
+  }
+  EXPECT_EQ(4, scheduler.GetNumDiskIOs());
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,386 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key_test.cpp
+//
+// Identification: test/storage/normalized_key_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_search.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the sign of comparing the rows column by column, the order normalized keys have to preserve */
+int CompareRows(const std::vector<Value> &lhs, const std::vector<Value> &rhs) {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int Sign(int value) { return (value > 0) - (value < 0); }
+
+/** Check both searches of every window against std::lower_bound and std::upper_bound on keys from -n to n. */
+template <size_t KeySize, typename ValueType>
+void CheckSearch(int n) {
+  using PairType = std::pair<NormalizedKey<KeySize>, ValueType>;
+  NormalizedComparator<KeySize> comparator;
+  std::vector<int64_t> values;
+  std::vector<PairType> array;
+  for (int64_t value = -n; value <= n; value += 2) {
+    values.push_back(value);
+    array.emplace_back();
+    array.back().first.SetFromInteger(value);
+  }
+
+  NormalizedKey<KeySize> key;
+  for (int64_t value = -n - 1; value <= n + 1; value++) {
+    key.SetFromInteger(value);
+    for (int low = 0; low < 3; low++) {
+      int high = static_cast<int>(values.size()) - low;
+      auto begin = values.begin() + low;
+      auto end = values.begin() + high;
+      ASSERT_EQ(std::lower_bound(begin, end, value) - values.begin(),
+                KeySearch::LowerBound(array.data(), low, high, key, comparator));
+      ASSERT_EQ(std::upper_bound(begin, end, value) - values.begin(),
+                KeySearch::UpperBound(array.data(), low, high, key, comparator));
+      // vector and scalar counts agree on a window
+      int window = std::min(high - low, KeySearch::SEARCH_WINDOW);
+      ASSERT_EQ((KeySearch::CountBefore<false, false>(array.data() + low, window, key)),
+                (KeySearch::CountBefore<false>(array.data() + low, window, key)));
+      ASSERT_EQ((KeySearch::CountBefore<true, false>(array.data() + low, window, key)),
+                (KeySearch::CountBefore<true>(array.data() + low, window, key)));
+    }
+  }
+}
+
+/**
+ * Walk the leaves from left to right, checking that the keys are in order and within the fences of their leaf.
+ * @return the number of leaves
+ */
+template <size_t KeySize>
+int CheckLeaves(BPlusTree<NormalizedKey<KeySize>, RID, NormalizedComparator<KeySize>> *tree, BufferPoolManager *bpm,
+                int *prefix_bytes) {
+  using LeafPage = BPlusTreeLeafPage<NormalizedKey<KeySize>, RID, NormalizedComparator<KeySize>>;
+  NormalizedComparator<KeySize> comparator;
+  int num_leaves = 0;
+  *prefix_bytes = 0;
+  Page *page = tree->FindLeafPage(NormalizedKey<KeySize>(), true);
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    num_leaves++;
+    *prefix_bytes += leaf->GetPrefixSize();
+    EXPECT_LE(leaf->GetSize(), leaf->GetMaxSize());
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      EXPECT_GE(comparator(leaf->KeyAt(i), leaf->GetLowKey()), 0);
+      if (leaf->GetNextPageId() != INVALID_PAGE_ID) {
+        EXPECT_LT(comparator(leaf->KeyAt(i), leaf->GetHighKey()), 0);
+      }
+      if (i > 0) {
+        EXPECT_LT(comparator(leaf->KeyAt(i - 1), leaf->KeyAt(i)), 0);
+      }
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page->GetPageId(), false);
+    page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+    if (page != nullptr) {
+      page->RLatch();
+    }
+  }
+  return num_leaves;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, OrderTest) {
+  Schema *key_schema = ParseCreateStatement("a smallint,b integer,c double,d varchar(6)");
+  NormalizedComparator<32> comparator(key_schema);
+
+  std::vector<int16_t> smallints = {-32767, -1, 0, 1, 32767};
+  std::vector<int32_t> integers = {-2147483647, -256, -1, 0, 1, 255, 2147483647};
+  std::vector<double> decimals = {-1e300, -2.5, -0.0, 0.0, 1e-300, 2.5, 1e300};
+  std::vector<std::string> varchars = {"", "a", "a\x01", "ab", "b", "zzzzzz"};
+
+  std::mt19937 rng(15445);
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 300; i++) {
+    rows.push_back({Value(TypeId::SMALLINT, smallints[rng() % smallints.size()]),
+                    Value(TypeId::INTEGER, integers[rng() % integers.size()]),
+                    Value(TypeId::DECIMAL, decimals[rng() % decimals.size()]),
+                    Value(TypeId::VARCHAR, varchars[rng() % varchars.size()])});
+  }
+
+  std::vector<NormalizedKey<32>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], key_schema), *key_schema);
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      ASSERT_EQ(CompareRows(rows[i], rows[j]), Sign(comparator(keys[i], keys[j]))) << "rows " << i << " and " << j;
+    }
+  }
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, VarLengthOrderTest) {
+  // a varchar in front of other columns must not let the bytes after it decide between a string and its prefix
+  Schema *key_schema = ParseCreateStatement("a varchar(300),b integer,c double");
+
+  std::vector<std::string> varchars = {"", "a", "a\x01", "aa", "ab", "b", std::string(300, 'z')};
+  std::vector<int32_t> integers = {-2147483647, -1, 0, 1, 2147483647};
+  std::vector<double> decimals = {-2.5, -0.0, 0.0, 2.5};
+
+  std::mt19937 rng(15445);
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 300; i++) {
+    rows.push_back({Value(TypeId::VARCHAR, varchars[rng() % varchars.size()]),
+                    Value(TypeId::INTEGER, integers[rng() % integers.size()]),
+                    Value(TypeId::DECIMAL, decimals[rng() % decimals.size()])});
+  }
+
+  std::vector<std::string> keys;
+  for (const auto &row : rows) {
+    keys.push_back(VarLengthKey::Encode(Tuple(row, key_schema), *key_schema));
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      ASSERT_EQ(CompareRows(rows[i], rows[j]), Sign(keys[i].compare(keys[j]))) << "rows " << i << " and " << j;
+    }
+  }
+  // keys take the bytes of their strings only
+  Tuple short_key({Value(TypeId::VARCHAR, std::string("abc")), Value(TypeId::INTEGER, 1), Value(TypeId::DECIMAL, 1.0)},
+                  key_schema);
+  EXPECT_EQ(3 + 2 + 4 + 8, VarLengthKey::Encode(short_key, *key_schema).size());
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, IntegerTest) {
+  NormalizedComparator<4> comparator4;
+  NormalizedComparator<8> comparator8;
+  NormalizedKey<4> lhs4;
+  NormalizedKey<4> rhs4;
+  NormalizedKey<8> lhs8;
+  NormalizedKey<8> rhs8;
+
+  std::vector<int64_t> values = {-2147483647, -65536, -1, 0, 1, 256, 2147483647};
+  for (auto lhs : values) {
+    lhs4.SetFromInteger(lhs);
+    lhs8.SetFromInteger(lhs);
+    EXPECT_EQ(lhs, lhs4.ToString());
+    EXPECT_EQ(lhs, lhs8.ToString());
+    for (auto rhs : values) {
+      rhs4.SetFromInteger(rhs);
+      rhs8.SetFromInteger(rhs);
+      int expected = (lhs > rhs) - (lhs < rhs);
+      EXPECT_EQ(expected, comparator4(lhs4, rhs4));
+      EXPECT_EQ(expected, comparator8(lhs8, rhs8));
+    }
+  }
+
+  // a single BIGINT column encodes the same as SetFromInteger
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  NormalizedKey<8> from_tuple;
+  from_tuple.SetFromKey(Tuple({Value(TypeId::BIGINT, static_cast<int64_t>(-42))}, key_schema), *key_schema);
+  lhs8.SetFromInteger(-42);
+  EXPECT_EQ(0, memcmp(lhs8.data_, from_tuple.data_, sizeof(lhs8.data_)));
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, SearchTest) {
+  static_assert(KeySearch::IsIntegerKey<NormalizedKey<8>, NormalizedComparator<8>>());
+  static_assert(!KeySearch::IsIntegerKey<NormalizedKey<16>, NormalizedComparator<16>>());
+  static_assert(!KeySearch::IsIntegerKey<GenericKey<8>, GenericComparator<8>>());
+
+  // leaf and internal pairs, i.e. strides of 8, 12 and 16 bytes
+  for (int n : {0, 6, 30, 101}) {
+    CheckSearch<4, page_id_t>(n);
+    CheckSearch<4, RID>(n);
+    CheckSearch<8, page_id_t>(n);
+    CheckSearch<8, RID>(n);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, BPlusTreeTest) {
+  NormalizedComparator<8> comparator;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  NormalizedKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = -500; key < 500; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key)), transaction);
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(static_cast<uint32_t>(key), rids[0].GetSlotNum());
+  }
+
+  // negative keys sort before positive ones
+  int64_t current_key = -500;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).first.ToString());
+    current_key++;
+  }
+  EXPECT_EQ(500, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(NormalizedKeyTest, CompressionTest) {
+  using Tree = BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+  NormalizedComparator<16> comparator;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  Tree tree("compressed", bpm, comparator, 1000, 1000, false, true);
+  Tree plain("plain", bpm, comparator);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 20000; key++) {
+    keys.push_back(key * 3 - 30000);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  NormalizedKey<16> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+    EXPECT_TRUE(plain.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+  }
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, RID()));
+
+  // leaves hold more pairs than uncompressed ones
+  int prefix_bytes;
+  int num_leaves = CheckLeaves(&tree, bpm, &prefix_bytes);
+  int plain_prefix_bytes;
+  int plain_leaves = CheckLeaves(&plain, bpm, &plain_prefix_bytes);
+  EXPECT_EQ(0, plain_prefix_bytes);
+  EXPECT_GE(prefix_bytes, num_leaves * 5);
+  EXPECT_LT(num_leaves * 5, plain_leaves * 4);
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(static_cast<uint32_t>(key), rids[0].GetSlotNum());
+    index_key.SetFromInteger(key + 1);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+
+  // merges and redistribution move the fences and change the prefixes
+  std::vector<int64_t> removed(keys.begin(), keys.begin() + 15000);
+  for (auto key : removed) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  CheckLeaves(&tree, bpm, &prefix_bytes);
+  std::vector<int64_t> remaining(keys.begin() + 15000, keys.end());
+  std::sort(remaining.begin(), remaining.end());
+  auto expected = remaining.begin();
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator, ++expected) {
+    ASSERT_NE(remaining.end(), expected);
+    EXPECT_EQ(*expected, (*iterator).first.ToString());
+    EXPECT_EQ(static_cast<uint32_t>(*expected), (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(remaining.end(), expected);
+  for (auto key : removed) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+  for (auto key : remaining) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // a bulk loaded tree takes more pairs once they are inserted
+  Tree loaded("loaded", bpm, comparator, 1000, 1000, false, true);
+  int64_t next_key = 0;
+  ASSERT_TRUE(loaded.BulkLoad([&](NormalizedKey<16> *key, RID *rid) {
+    if (next_key == 20000) {
+      return false;
+    }
+    key->SetFromInteger(next_key * 2);
+    *rid = RID(0, static_cast<uint32_t>(next_key * 2));
+    next_key++;
+    return true;
+  }));
+  for (int64_t key = 1; key < 40000; key += 2) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(loaded.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+  }
+  CheckLeaves(&loaded, bpm, &prefix_bytes);
+  int64_t current_key = 0;
+  for (auto iterator = loaded.begin(); iterator != loaded.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).first.ToString());
+    current_key++;
+  }
+  EXPECT_EQ(40000, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_size_benchmark_test.cpp
+//
+// Identification: test/storage/page_size_benchmark_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/hash_table_header_page.h"
+#include "storage/page/hash_table_page_defs.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * Compares the same workload across page sizes. Build once per page size and run this test in each build:
+ *   build_support/run_page_size_benchmark.sh
+ * or by hand:
+ *   cmake -DBUSTUB_PAGE_SIZE=16384 .. && make page_size_benchmark_test
+ *   ./test/page_size_benchmark_test --gtest_also_run_disabled_tests
+ */
+// NOLINTNEXTLINE
+TEST(PageSizeBenchmarkTest, DISABLED_ScanAndPointLookupTest) {
+  using KeyType = GenericKey<8>;
+  using ValueType = RID;
+  const int num_tuples = 200000;
+  const int num_lookups = 100000;
+  const int num_ranges = 1000;
+  const int range_size = 1000;
+  // the buffer pool covers the same number of bytes whatever the page size
+  const size_t pool_bytes = 1 << 20;
+  const size_t pool_size = std::max<size_t>(pool_bytes / PAGE_SIZE, 4);
+
+  Schema schema({Column{"id", TypeId::BIGINT}, Column{"payload", TypeId::VARCHAR, 100}});
+  std::string payload(100, 'x');
+
+  remove("test.db");
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+  Transaction txn(0);
+  // the header page, where the B+ tree and the hash table keep their roots
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  // load: fill table pages one after another, chaining them like TableHeap does
+  auto start = std::chrono::steady_clock::now();
+  std::vector<RID> rids;
+  rids.reserve(num_tuples);
+  page_id_t first_page_id;
+  auto *page = reinterpret_cast<TablePage *>(bpm->NewPage(&first_page_id));
+  page->Init(first_page_id, PAGE_SIZE, INVALID_PAGE_ID, nullptr, nullptr);
+  int num_pages = 1;
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetVarcharValue(payload)}, &schema);
+    RID rid;
+    if (!page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr)) {
+      page_id_t next_page_id;
+      auto *next_page = reinterpret_cast<TablePage *>(bpm->NewPage(&next_page_id));
+      next_page->Init(next_page_id, PAGE_SIZE, page->GetTablePageId(), nullptr, nullptr);
+      page->SetNextPageId(next_page_id);
+      bpm->UnpinPage(page->GetTablePageId(), true);
+      page = next_page;
+      num_pages++;
+      ASSERT_TRUE(page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr));
+    }
+    rids.push_back(rid);
+  }
+  bpm->UnpinPage(page->GetTablePageId(), true);
+  bpm->FlushAllPages();
+  double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  TableHeap table(bpm, nullptr, nullptr, first_page_id);
+
+  // full scan
+  start = std::chrono::steady_clock::now();
+  int scanned = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+    scanned++;
+  }
+  double scan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(num_tuples, scanned);
+
+  // uniformly random point lookups, most of which miss the buffer pool
+  std::shuffle(rids.begin(), rids.end(), std::default_random_engine(0));
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table.GetTuple(rids[i], &tuple, &txn));
+  }
+  double lookup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // the ids as keys of a B+ tree and of a hash table, inserted in random order; both go before the buffer pool does.
+  // The hash table holds as many as it can at a quarter load without outgrowing its header page.
+  const size_t hash_keys =
+      std::min<size_t>(num_tuples, HashTableHeaderPage::MaxNumBlocks() * FINGERPRINT_BLOCK_ARRAY_SIZE / 4);
+  double range_seconds;
+  double tree_lookup_seconds;
+  double probe_seconds;
+  {
+    Schema key_schema({Column{"id", TypeId::BIGINT}});
+    GenericComparator<8> comparator(&key_schema);
+    BPlusTree<KeyType, ValueType, GenericComparator<8>> tree("bench_tree", bpm, comparator);
+    LinearProbeHashTable<KeyType, ValueType, GenericComparator<8>> hash_table("bench_hash", bpm, comparator,
+                                                                               4 * hash_keys, HashFunction<KeyType>());
+    std::vector<int64_t> ids(num_tuples);
+    for (int i = 0; i < num_tuples; i++) {
+      ids[i] = i;
+    }
+    std::shuffle(ids.begin(), ids.end(), std::default_random_engine(1));
+    KeyType key;
+    for (int i = 0; i < num_tuples; i++) {
+      key.SetFromInteger(ids[i]);
+      ASSERT_TRUE(tree.Insert(key, RID(ids[i])));
+      if (static_cast<size_t>(i) < hash_keys) {
+        ASSERT_TRUE(hash_table.Insert(&txn, key, RID(ids[i])));
+      }
+    }
+
+    // range scans of range_size keys from random starts
+    std::default_random_engine engine(2);
+    std::uniform_int_distribution<int64_t> range_start(0, num_tuples - range_size);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_ranges; i++) {
+      key.SetFromInteger(range_start(engine));
+      auto it = tree.Begin(key);
+      for (int j = 0; j < range_size; j++, ++it) {
+        ASSERT_FALSE(it.isEnd());
+      }
+    }
+    range_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // uniformly random point lookups in the B+ tree, then probes of the hash table for the keys it holds
+    start = std::chrono::steady_clock::now();
+    std::vector<ValueType> result;
+    for (int i = 0; i < num_lookups; i++) {
+      result.clear();
+      key.SetFromInteger(ids[i]);
+      ASSERT_TRUE(tree.GetValue(key, &result));
+    }
+    tree_lookup_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; i++) {
+      result.clear();
+      key.SetFromInteger(ids[i % hash_keys]);
+      ASSERT_TRUE(hash_table.GetValue(&txn, key, &result));
+    }
+    probe_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  printf("page size:                  %d bytes\n", PAGE_SIZE);
+  printf("buffer pool:                %zu frames\n", pool_size);
+  printf("table pages:                %d (%.1f tuples per page)\n", num_pages,
+         static_cast<double>(num_tuples) / num_pages);
+  printf("b+ tree leaf capacity:      %d (GenericKey<8>)\n",
+         BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>::Capacity(0));
+  printf("b+ tree internal fan-out:   %d (GenericKey<8>)\n",
+         BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>::Capacity(0));
+  printf("hash table block capacity:  %zu (GenericKey<8>)\n", BLOCK_ARRAY_SIZE);
+  printf("fingerprint block capacity: %zu (GenericKey<8>)\n", FINGERPRINT_BLOCK_ARRAY_SIZE);
+  printf("hash table keys:            %zu\n", hash_keys);
+  printf("load:                       %.0f tuples/s\n", num_tuples / load_seconds);
+  printf("sequential scan:            %.0f tuples/s\n", num_tuples / scan_seconds);
+  printf("random point lookup:        %.0f lookups/s\n", num_lookups / lookup_seconds);
+  printf("b+ tree range scan:         %.0f keys/s\n", static_cast<double>(num_ranges) * range_size / range_seconds);
+  printf("b+ tree point lookup:       %.0f lookups/s\n", num_lookups / tree_lookup_seconds);
+  printf("hash table probe:           %.0f probes/s\n", num_lookups / probe_seconds);
+
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+}  // namespace bustub
@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_disk_manager_test.cpp
+//
+// Identification: test/storage/simulated_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/simulated_disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, ReadWritePageTest) {
+  SimulatedDiskManager dm(DiskProfile::Nvme());
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // a page that was never written reads as zeros
+  memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, memcmp(buf, data, sizeof(buf)));
+
+  std::vector<char> pages(3 * PAGE_SIZE, 'p');
+  dm.WritePages(4, pages.data(), 3);
+  dm.ReadPage(6, buf);
+  EXPECT_EQ('p', buf[0]);
+  EXPECT_EQ(2, dm.GetNumWrites());
+  EXPECT_EQ(4U * PAGE_SIZE, dm.GetNumBytesWritten());
+
+  dm.DeallocatePage(0);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  char log[16] = "log record";
+  char log_buf[16];
+  dm.WriteLog(log, sizeof(log));
+  EXPECT_EQ(1, dm.GetNumFlushes());
+  EXPECT_TRUE(dm.ReadLog(log_buf, sizeof(log_buf), 0));
+  EXPECT_EQ(0, memcmp(log, log_buf, sizeof(log)));
+  EXPECT_FALSE(dm.ReadLog(log_buf, sizeof(log_buf), sizeof(log)));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, LatencyModelTest) {
+  // one page per millisecond of transfer
+  DiskProfile profile{10, 20, 100, PAGE_SIZE * 1000, 1};
+  SimulatedDiskManager dm(profile);
+  char data[PAGE_SIZE] = {0};
+
+  dm.WritePage(0, data);  // 20 + 1000
+  dm.WritePage(1, data);  // sequential: 20 + 1000
+  dm.ReadPage(5, data);   // seek: 10 + 100 + 1000
+  std::vector<char> pages(2 * PAGE_SIZE);
+  dm.ReadPages(6, pages.data(), 2);  // sequential, two pages: 10 + 2000
+  EXPECT_EQ(5160U, dm.GetElapsedTime());
+
+  auto trace = dm.GetTrace();
+  ASSERT_EQ(4U, trace.size());
+  EXPECT_EQ(DiskAccess::Type::WRITE, trace[0].type_);
+  EXPECT_EQ(0U, trace[0].issue_us_);
+  EXPECT_EQ(1020U, trace[0].complete_us_);
+  EXPECT_EQ(DiskAccess::Type::READ, trace[2].type_);
+  EXPECT_EQ(5, trace[2].page_id_);
+  EXPECT_EQ(2040U, trace[2].issue_us_);
+  EXPECT_EQ(3150U, trace[2].complete_us_);
+  EXPECT_EQ(2, trace[3].num_pages_);
+
+  dm.ClearTrace();
+  dm.EnableTrace(false);
+  dm.ReadPage(0, data);
+  EXPECT_TRUE(dm.GetTrace().empty());
+}
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, QueueDepthTest) {
+  const int num_threads = 4;
+  auto run = [&](int queue_depth) {
+    // latency only, so that requests overlap as long as the queue has room
+    SimulatedDiskManager dm(DiskProfile{100, 100, 0, 0, queue_depth});
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&dm, tid] {
+        char buf[PAGE_SIZE];
+        dm.ReadPage(tid * 10, buf);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    return dm.GetElapsedTime();
+  };
+
+  EXPECT_EQ(400U, run(1));
+  EXPECT_EQ(200U, run(2));
+  EXPECT_EQ(100U, run(num_threads));
+}
+
+// NOLINTNEXTLINE
+TEST(SimulatedDiskManagerTest, BufferPoolTest) {
+  SimulatedDiskManager dm(DiskProfile::Hdd());
+  BufferPoolManager bpm(2, &dm);
+
+  page_id_t page_ids[3];
+  for (auto &page_id : page_ids) {
+    auto *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm.UnpinPage(page_id, true);
+  }
+
+  // the first page was evicted to the simulated disk and comes back intact
+  auto *page = bpm.FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 0", page->GetData());
+  bpm.UnpinPage(page_ids[0], false);
+
+  bpm.FlushAllPages();
+  EXPECT_FALSE(dm.GetTrace().empty());
+  EXPECT_GT(dm.GetElapsedTime(), 0U);
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,258 @@
+/**
+ * var_length_b_plus_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/index/var_length_b_plus_tree.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return a random key of length 1 to max_length, from a small alphabet so that keys share long prefixes */
+std::string RandomKey(std::mt19937 *rng, size_t max_length) {
+  std::string key((*rng)() % max_length + 1, 'a');
+  for (auto &c : key) {
+    c = static_cast<char>('a' + (*rng)() % 3);
+  }
+  return key;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(VarLengthBPlusTreeTests, SlottedPageTest) {
+  alignas(8) char data[PAGE_SIZE];
+  alignas(8) char other_data[PAGE_SIZE];
+  auto *page = reinterpret_cast<BPlusTreeSlottedPage<RID> *>(data);
+  auto *other = reinterpret_cast<BPlusTreeSlottedPage<RID> *>(other_data);
+  page->Init(1);
+  other->Init(2);
+  EXPECT_TRUE(page->IsLeafPage());
+
+  // fill the page with keys of different lengths, in random order
+  std::mt19937 rng(15445);
+  std::vector<std::string> keys;
+  while (true) {
+    std::string key = RandomKey(&rng, 100);
+    int index = page->KeyIndex(key);
+    if (index < page->GetSize() && page->KeyAt(index) == key) {
+      continue;
+    }
+    if (!page->HasRoom(key.size())) {
+      break;
+    }
+    page->InsertAt(index, key, RID(key.size(), 0));
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  ASSERT_EQ(keys.size(), page->GetSize());
+  for (int i = 0; i < page->GetSize(); i++) {
+    EXPECT_EQ(keys[i], page->KeyAt(i));
+    EXPECT_EQ(RID(keys[i].size(), 0), page->ValueAt(i));
+  }
+
+  // removed entries leave garbage, which is reclaimed once an insertion needs it
+  std::string longest = keys[0];
+  for (int i = page->GetSize() - 1; i >= 0; i -= 2) {
+    if (page->KeyAt(i).size() > longest.size()) {
+      longest = std::string(page->KeyAt(i));
+    }
+    page->RemoveAt(i);
+  }
+  EXPECT_TRUE(page->HasRoom(longest.size()));
+  int count = 0;
+  for (std::string key = longest + "x"; page->HasRoom(key.size()); key += "x") {
+    page->InsertAt(page->KeyIndex(key), key, RID(0, count++));
+  }
+  EXPECT_GT(count, 1);
+  for (int i = 1; i < page->GetSize(); i++) {
+    EXPECT_LT(page->KeyAt(i - 1), page->KeyAt(i));
+  }
+
+  // a split separates the two pages with a prefix of the first key that moved
+  int size = page->GetSize();
+  std::string separator = page->MoveHalfTo(other);
+  EXPECT_EQ(size, page->GetSize() + other->GetSize());
+  EXPECT_GT(page->GetSize(), 0);
+  EXPECT_GT(other->GetSize(), 0);
+  EXPECT_LT(page->KeyAt(page->GetSize() - 1), separator);
+  EXPECT_LE(separator, other->KeyAt(0));
+  EXPECT_EQ(separator, other->KeyAt(0).substr(0, separator.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(VarLengthBPlusTreeTests, InsertRemoveTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarLengthBPlusTree tree("foo_pk", bpm);
+  Transaction *transaction = new Transaction(0);
+
+  // keys up to the longest one the tree takes, so that pages only hold a few of them
+  std::mt19937 rng(15445);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 3000; i++) {
+    std::string key = RandomKey(&rng, i % 10 == 0 ? tree.MaxKeySize() : 40);
+    bool inserted = std::find(keys.begin(), keys.end(), key) == keys.end();
+    EXPECT_EQ(inserted, tree.Insert(key, RID(i, i), transaction));
+    if (inserted) {
+      keys.push_back(key);
+    }
+  }
+
+  std::vector<RID> rids;
+  for (const auto &key : keys) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(key, &rids));
+    ASSERT_EQ(1, rids.size());
+  }
+  EXPECT_FALSE(tree.GetValue(std::string(tree.MaxKeySize(), 'z'), &rids));
+
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    tree.Remove(keys[i], transaction);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    EXPECT_EQ(i % 2 == 1, tree.GetValue(keys[i], &rids));
+  }
+  // removed keys can come back
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    EXPECT_TRUE(tree.Insert(keys[i], RID(0, i), transaction));
+  }
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    rids.clear();
+    ASSERT_TRUE(tree.GetValue(keys[i], &rids));
+    EXPECT_EQ(RID(0, i), rids[0]);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(VarLengthBPlusTreeTests, NonUniqueTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarLengthBPlusTree tree("foo_pk", bpm, false);
+  EXPECT_EQ(tree.MaxKeySize() + sizeof(RID), BPlusTreeSlottedPage<RID>::MaxKeySize());
+
+  // the values of a key span several leaves, next to keys that extend it
+  std::string key(300, 'k');
+  const int num_values = 500;
+  for (int i = num_values - 1; i >= 0; i--) {
+    EXPECT_TRUE(tree.Insert(key, RID(i, i)));
+    EXPECT_TRUE(tree.Insert(key + "k", RID(i, i)));
+    EXPECT_TRUE(tree.Insert(key.substr(1), RID(i, i)));
+  }
+  EXPECT_FALSE(tree.Insert(key, RID(7, 7)));
+
+  std::vector<RID> rids;
+  ASSERT_TRUE(tree.GetValue(key, &rids));
+  ASSERT_EQ(num_values, rids.size());
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_EQ(RID(i, i), rids[i]);
+  }
+
+  // remove a single value, then all of them
+  tree.Remove(key, RID(7, 7));
+  rids.clear();
+  ASSERT_TRUE(tree.GetValue(key, &rids));
+  EXPECT_EQ(num_values - 1, rids.size());
+  tree.Remove(key);
+  rids.clear();
+  EXPECT_FALSE(tree.GetValue(key, &rids));
+  ASSERT_TRUE(tree.GetValue(key + "k", &rids));
+  EXPECT_EQ(num_values, rids.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(VarLengthBPlusTreeTests, KeyTooLongTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarLengthBPlusTree tree("foo_pk", bpm);
+
+  std::string key(tree.MaxKeySize() + 1, 'x');
+  EXPECT_THROW(tree.Insert(key, RID(0, 0)), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+  std::vector<RID> rids;
+  EXPECT_FALSE(tree.GetValue(key, &rids));
+  tree.Remove(key);
+  key.pop_back();
+  EXPECT_TRUE(tree.Insert(key, RID(0, 0)));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(VarLengthBPlusTreeTests, ConcurrentInsertTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarLengthBPlusTree tree("foo_pk", bpm);
+
+  // each thread inserts its own keys while looking up those it already inserted
+  const int num_threads = 4;
+  const int keys_per_thread = 1000;
+  auto key_of = [](int thread, int i) { return std::string(i % 200 + 1, 'a' + thread) + std::to_string(i); };
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::vector<RID> rids;
+      for (int i = 0; i < keys_per_thread; i++) {
+        EXPECT_TRUE(tree.Insert(key_of(t, i), RID(t, i)));
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(key_of(t, i / 2), &rids));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> rids;
+  for (int t = 0; t < num_threads; t++) {
+    for (int i = 0; i < keys_per_thread; i++) {
+      rids.clear();
+      ASSERT_TRUE(tree.GetValue(key_of(t, i), &rids));
+      EXPECT_EQ(RID(t, i), rids[0]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub